@@ -0,0 +1,83 @@
+#ifndef _ACCOUNTING_H
+#define _ACCOUNTING_H
+
+#include <atomic>
+#include <memory_resource>
+#include <string>
+
+namespace Novorado
+{
+	namespace Partition
+	{
+		// Memory resource counting the bytes it holds from <upstream>. Writers
+		// are serialized by the owner, as with the pmr resources it feeds,
+		// counters may be read from any thread
+		class CountingResource : public std::pmr::memory_resource
+		{
+			public:
+				explicit CountingResource(std::pmr::memory_resource* upstream=std::pmr::get_default_resource()):
+					m_Upstream(upstream)
+				{
+				}
+				CountingResource(const CountingResource&) = delete;
+				CountingResource& operator=(const CountingResource&) = delete;
+
+				size_t InUse() const noexcept { return m_InUse.load(std::memory_order_relaxed); }
+				size_t Peak() const noexcept { return m_Peak.load(std::memory_order_relaxed); }
+
+			private:
+				void* do_allocate(size_t bytes,size_t align) override
+				{
+					void* p=m_Upstream->allocate(bytes,align);
+					const size_t n=m_InUse.load(std::memory_order_relaxed)+bytes;
+					m_InUse.store(n,std::memory_order_relaxed);
+					if(n>m_Peak.load(std::memory_order_relaxed)) m_Peak.store(n,std::memory_order_relaxed);
+					return p;
+				}
+				void do_deallocate(void* p,size_t bytes,size_t align) override
+				{
+					m_Upstream->deallocate(p,bytes,align);
+					m_InUse.store(m_InUse.load(std::memory_order_relaxed)-bytes,std::memory_order_relaxed);
+				}
+				bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+				{
+					return this==&other;
+				}
+
+				std::pmr::memory_resource* m_Upstream;
+				std::atomic<size_t> m_InUse{0},m_Peak{0};
+		};
+
+		// Heap bytes of a string, none while it fits the string itself
+		inline size_t HeapBytes(const std::string& s) noexcept
+		{
+			return s.capacity()>std::string().capacity()?s.capacity()+1:0;
+		}
+
+		// Bytes of a hypergraph by subsystem, see NetlistHypergraph::GetMemoryStats()
+		struct MemoryStats
+		{
+			struct Bytes
+			{
+				size_t current{0},peak{0};
+			};
+
+			Bytes topology; // cells, nets, pins and the pin lists
+			Bytes names; // of cells, nets and pins
+			Bytes state; // CellState and the pass loop workspace
+			Bytes buckets; // gain list nodes of both sides
+			Bytes solutions; // bestSolution records
+
+			size_t Current() const
+			{
+				return topology.current+names.current+state.current+buckets.current+solutions.current;
+			}
+			// Sum of the peaks, which need not be simultaneous: an upper bound
+			size_t Peak() const
+			{
+				return topology.peak+names.peak+state.peak+buckets.peak+solutions.peak;
+			}
+		};
+	}
+}
+#endif//_ACCOUNTING_H
@@ -0,0 +1,105 @@
+#ifndef _BATCH_H
+#define _BATCH_H
+
+#include "klfm18.h"
+#include "cache.h"
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
+namespace Novorado
+{
+	namespace Partition
+	{
+		/*! Partitions many netlists concurrently
+		 *
+		 * Every job loads its netlist into a KLFM of its own, runs the seeded
+		 * InitialPartitioner portfolio then KLFM::Refine(), and optionally writes
+		 * the sides in .part format. Workers take jobs in manifest order, so
+		 * loads of some jobs overlap partitioning of others. A job is admitted
+		 * once its memory estimate, proportional to the input size, fits the
+		 * budget with the jobs running; a single job is always admitted. With a
+		 * job limit, a loaded netlist whose NetlistHypergraph::EstimateRun()
+		 * peak is over it fails before partitioning.
+		 *
+		 * With a cache directory, converged results are stored and reused by
+		 * jobs of the same netlist and seed (see ResultCache). A converged run
+		 * does not depend on its time budget, so the budget is not in the key.
+		 *
+		 * Manifest: a job per line, "<netlist> [key=value ...]" with keys
+		 * output, seed, budget and large (see Job), '#' starts a comment.
+		 */
+		class BatchRunner
+		{
+			public:
+				struct Job
+				{
+					string input;
+					string output; // .part file, none when empty
+					uint32_t seed{2018};
+					double budget{-1}; // KLFM::SetTimeBudget, seconds
+					size_t large{0}; // NetlistHypergraph::m_LargeNetThreshold
+				};
+
+				struct Result
+				{
+					bool ok{false};
+					string error;
+					size_t cells{0},nets{0};
+					Weight cut{0};
+					Square left{0},right{0};
+					bool converged{false};
+					double loadTime{0},partitionTime{0}; // seconds
+					size_t memory{0}; // estimate the job was admitted with
+					size_t peakMemory{0}; // NetlistHypergraph::GetMemoryStats() peak
+					bool cached{false}; // sides taken from the result cache
+				};
+
+				struct Params
+				{
+					unsigned int threads{0}; // 0 means hardware concurrency
+					size_t memory{0}; // bytes of jobs running at once, 0 unlimited
+					size_t limit{0}; // bytes of a single job, 0 unlimited
+					string cache; // directory of a ResultCache, none when empty
+				};
+
+				using Loader = std::function<std::shared_ptr<KLFM>(const string&)>;
+
+				// Estimated bytes of a loaded netlist per byte of its file
+				static constexpr size_t MemoryPerInputByte = 16;
+
+				BatchRunner(Loader,const Params&);
+
+				void Add(const Job& j) { m_Jobs.push_back(j); }
+				// Throws std::runtime_error on a missing file or a bad line
+				void ReadManifest(const string& fn);
+
+				// Results in job order, a failed job does not stop the others
+				const std::vector<Result>& Run();
+
+				// JSON object with the results of every job and their totals
+				void WriteReport(const string& fn) const;
+
+				const std::vector<Job>& GetJobs() const { return m_Jobs; }
+				const std::vector<Result>& GetResults() const { return m_Results; }
+				// Cache use of the runs so far, zeros without a cache
+				ResultCache::Stats GetCacheStats() const;
+
+			private:
+				void run(const Job&,Result&);
+				void admit(size_t bytes);
+				void release(size_t bytes);
+
+				Loader m_Loader;
+				Params m_Params;
+				std::vector<Job> m_Jobs;
+				std::vector<Result> m_Results;
+				std::unique_ptr<ResultCache> m_Cache;
+
+				std::mutex m_Mutex;
+				std::condition_variable m_Admitted;
+				size_t m_InUse{0};
+		};
+	}
+}
+#endif//_BATCH_H
@@ -3,14 +3,36 @@
 
 #include <string>
 #include <memory>
+#include <stdexcept>
+#include <cstdint>
+#include <limits>
 
 namespace Novorado
 {
 	namespace Partition
 	{
 		using string = std::string;
-		using Coordinate = long;
-		using Index = long;
+
+		// Core widths, 32 bit unless built with KLFM_WIDE_TYPES (make WIDE=1)
+		// for designs that do not fit. Hot arrays are indexed and summed in
+		// these types, the loader checks that the design fits (CheckLimits)
+		#ifdef KLFM_WIDE_TYPES
+		using Index = std::uint64_t;
+		using Coordinate = std::int64_t;
+		using Weight = std::int64_t;
+		using Square = std::int64_t;
+		#else
+		using Index = std::uint32_t;
+		using Coordinate = std::int32_t;
+		using Weight = std::int32_t;
+		using Square = std::int32_t;
+		#endif
+
+		// Sums of gains over the hypergraph, pin pairs of a net grow with the
+		// square of its pins and do not fit Weight
+		using Cost = std::int64_t;
+
+		constexpr Index InvalidIndex = std::numeric_limits<Index>::max();
 
 		namespace Bridge
 		{
@@ -18,6 +40,10 @@ namespace Novorado
 			{
 				Rect() = default;
 				Rect(const Rect&) = default;
+				Rect& operator=(const Rect&) = default;
+
+				constexpr Rect(Coordinate l,Coordinate b,Coordinate r,Coordinate t) noexcept:
+					m_left{l},m_right{r},m_top{t},m_bottom{b}{}
 
 				constexpr Coordinate vCenter() const noexcept
 				{
@@ -49,6 +75,36 @@ namespace Novorado
 					return m_top;
 				}
 
+				constexpr Coordinate left() const noexcept
+				{
+					return m_left;
+				}
+
+				constexpr Coordinate bottom() const noexcept
+				{
+					return m_bottom;
+				}
+
+				constexpr Coordinate right() const noexcept
+				{
+					return m_right;
+				}
+
+				constexpr Coordinate top() const noexcept
+				{
+					return m_top;
+				}
+
+				constexpr Coordinate width() const noexcept
+				{
+					return m_right-m_left;
+				}
+
+				constexpr Coordinate height() const noexcept
+				{
+					return m_top-m_bottom;
+				}
+
 				private:
 
 					Coordinate
@@ -58,7 +114,7 @@ namespace Novorado
             struct Id
 			{
 
-				explicit Id(Index index=-1, string name=string())
+				explicit Id(Index index=InvalidIndex, string name=string())
 				{
 					SetId(index);
 					SetName(name);
@@ -71,12 +127,12 @@ namespace Novorado
 					return m_index;
 				}
 
-				constexpr unsigned int GetUnsignedId() const noexcept
+				constexpr Index GetUnsignedId() const noexcept
 				{
-					return static_cast<unsigned int>(m_index);
+					return m_index;
 				}
 
-				auto GetName() const noexcept
+				const string& GetName() const noexcept
 				{
 					return m_name;
 				}
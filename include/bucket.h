@@ -3,13 +3,23 @@
 
 #include "celllist.h"
 #include "net.h"
+#include "accounting.h"
 #include <map>
+#include <memory_resource>
 
 namespace Novorado
 {
 	namespace Partition
 	{
-		class Bucket : public std::map<Weight,CellList>
+		// Pool of the gain list nodes. It is a base so it is constructed before
+		// the map; erased nodes are reused and the pass loop does not allocate
+		struct BucketPool
+		{
+			CountingResource m_Heap;
+			std::pmr::unsynchronized_pool_resource m_Pool{&m_Heap};
+		};
+
+		class Bucket : private BucketPool, public std::pmr::map<Weight,CellList>
 		{
 			public:
 				virtual ~Bucket();
@@ -19,16 +29,23 @@ namespace Novorado
 				{
 					m_Partition=p;
 				}
-				void FillByGain(CellList&);
+				// Moves the free cells of the locker to the gain lists, appended or
+				// at the <head>
+				void FillByGain(CellList&,bool head=false);
+				// Moves the cells left to the locker given, e.g. when a pass is cut short
+				void Drain(CellList&);
 				void dbg(long);
 				Square GetSquare() const { return m_Square; }
 				void SubtractSquare(Square s) { m_Square-=s; }
-				Weight GetGain() const { return m_SumGain;}
+				Cost GetGain() const { return m_SumGain;}
 				void IncrementGain(Weight g);
+				// Bytes of the node pool, it keeps the nodes of erased gains
+				size_t HeapBytes() const { return m_Heap.InUse(); }
+				size_t PeakHeapBytes() const { return m_Heap.Peak(); }
 			protected:
 			private:
 				Square m_Square;
-				Weight m_SumGain;
+				Cost m_SumGain;
 				Partition* m_Partition;
 				Bucket();
 				friend class Partition;
@@ -0,0 +1,52 @@
+#ifndef _CACHE_H
+#define _CACHE_H
+
+#include "hypergraph.h"
+#include <atomic>
+
+namespace Novorado
+{
+	namespace Partition
+	{
+		/*! On-disk cache of partitioning results, addressed by content
+		 *
+		 * The key hashes the canonical hypergraph, i.e. cells in id order with
+		 * their square and fixed side, nets with their weight and sorted cell
+		 * ids, in sorted order so the net order of the file does not matter,
+		 * the large net threshold, and the run parameters given as a string.
+		 * Names are left out. A result is taken only if the cell, net and pin
+		 * counts stored with it are those of the netlist and the cut recomputed
+		 * from its sides is the one stored.
+		 */
+		class ResultCache
+		{
+			public:
+				struct Stats
+				{
+					size_t hits{0},misses{0};
+					size_t rejected{0}; // found, failed verification
+					size_t stored{0};
+				};
+
+				// Directory is created if missing
+				explicit ResultCache(const string& dir);
+
+				// 32 hex digits
+				static string Key(const NetlistHypergraph&,const string& params);
+
+				// Writes the sides of a hit to the cells and the lockers
+				bool Load(NetlistHypergraph&,const string& key);
+				// Sides and cut of the hypergraph, throws std::runtime_error
+				void Store(const NetlistHypergraph&,const string& key);
+
+				Stats GetStats() const;
+
+			private:
+				string path(const string& key) const { return m_Dir+"/"+key+".klfm"; }
+
+				string m_Dir;
+				std::atomic<size_t> m_Hits{0},m_Misses{0},m_Rejected{0},m_Stored{0};
+		};
+	}
+}
+#endif//_CACHE_H
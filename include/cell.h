@@ -3,7 +3,9 @@
 
 #include "bridge.h"
 #include "net.h"
+#include "cellstate.h"
 #include <list>
+#include <memory_resource>
 
 namespace Novorado
 {
@@ -11,46 +13,58 @@ namespace Novorado
 	{
 		class Partition;
 		class Pin;
+		class CellList;
 
-		using Square = long;
-
+		// Cold part of the cell: name, pins and list links. Gain, side, lock
+		// and square live in the CellState slot given by the cell id, the cell
+		// has to be attached to a state (NetlistHypergraph::AddCell) before use
 		class Cell : public Bridge::Id
 		{
 			public:
 				Cell();
+				// Pins are allocated from <arena>
+				explicit Cell(std::pmr::memory_resource* arena);
 				Cell(Cell& other);
 				Cell(const Cell& other);
 				Cell& operator=(Cell&);
 				virtual ~Cell();
-				Square GetSquare() const { return m_Square; }
-				void SetSquare(Square val) { m_Square = val; }
-				Partition* GetPartition();
+				void Attach(CellState* s) { m_State=s; }
+				Square GetSquare() const { return m_State->area[GetUnsignedId()]; }
+				void SetSquare(Square val) { m_State->area[GetUnsignedId()] = val; }
+				Partition* GetPartition() const { return m_State->GetPartition(GetUnsignedId()); }
 				void SetPartition(Partition*);
-				Weight GetGain() const { return m_Gain; }
-				void SetGain(Weight w) { m_Gain=w; }
+				Weight GetGain() const { return m_State->gain[GetUnsignedId()]; }
+				void SetGain(Weight w) { m_State->gain[GetUnsignedId()]=w; }
 				void IncrementGain(Weight w);
 				bool operator==(const Cell& c) const
 				{
 					return c.GetId()==GetId();
 				}
 				void MoveToLocker(bool f=true);
-				bool IsInLocker() const { return flags.inLocker; }
+				bool IsInLocker() const { return m_State->lock[GetUnsignedId()]; }
 				bool IsFixed() const { return flags.fixed; }
 				void SetFixed(bool f=true) { flags.fixed=f; }
 
-				std::list<Pin> m_Pins;
+				std::pmr::list<Pin> m_Pins;
 
 			private:
+				friend class CellList;
+
+				// Intrusive CellList links, never copied with the cell
+				struct ListHook
+				{
+					Cell* prev{nullptr};
+					Cell* next{nullptr};
+					CellList* owner{nullptr};
+				} m_Hook;
+
 				struct Flags
 				{
-					Flags():inLocker(false),fixed(false){}
-					bool inLocker	: 1;
+					Flags():fixed(false){}
 					bool fixed	: 1;
 				} flags;
 
-				Weight m_Gain=0;
-				Partition* m_PartitionPtr{nullptr};
-				Square m_Square=0;
+				CellState* m_State{nullptr};
 		};
 	}
 }
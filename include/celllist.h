@@ -2,131 +2,114 @@
 #define _CELLLIST_H
 
 #include "cell.h"
+#include <iterator>
 
 namespace Novorado
 {
 namespace Partition
 {
+// Intrusive doubly linked list of cells, links are kept in the cell itself
+// (Cell::m_Hook), so every cell can be on one list at a time.
+// Insertion, removal and lookup are O(1), size and square are maintained
+// on every change.
 class CellList
 {
-    std::vector<long> cellId2cells;
-    std::vector<Cell*> cells;
-    bool dirty=false; // dirty when there are NULLs in cells() array
-    void pack();
+    Cell* m_Head{nullptr};
+    Cell* m_Tail{nullptr};
+    size_t m_Size{0};
+    void link(Cell* pos,Cell& cell);
+    void unlink(Cell& cell);
 public:
     class Iterator
     {
-        CellList* L{nullptr};
-        long idx=-1;
+        Cell* m_Cell{nullptr};
         friend CellList;
     public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Cell;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Cell*;
+        using reference = Cell&;
 
-    	virtual ~Iterator()
-    	{
-    	}
+        Iterator() = default;
 
-        Iterator(CellList* l,long _idx):
-            L(l),idx(_idx)
+        explicit Iterator(Cell* c):
+            m_Cell(c)
         {
         }
 
         bool operator!=(const Iterator& i) const
         {
-            if(L->dirty)
-                throw std::logic_error("integrity");
-            return idx!=i.idx;
+            return m_Cell!=i.m_Cell;
         }
 
         bool operator==(const Iterator& i) const
         {
-            if(L->dirty)
-                throw std::logic_error("integrity");
-            return idx==i.idx;
+            return m_Cell==i.m_Cell;
         }
 
-        Iterator operator++()
+        Iterator& operator++()
         {
-            if(L->dirty)
-                L->pack();
-            idx++;
+            m_Cell=m_Cell->m_Hook.next;
             return *this;
         }
 
         Iterator operator++(int /* mark postfix*/)
         {
-            if(L->dirty)
-                L->pack();
             Iterator rv(*this);
-            idx++;
+            m_Cell=m_Cell->m_Hook.next;
             return rv;
         }
 
-        Iterator operator--(int)
+        Cell* operator->() const
         {
-            if(L->dirty)
-                L->pack();
-            Iterator rv(*this);
-            idx--;
-            return rv;
-        }
-
-        Cell* operator->()
-        {
-            if(L->dirty)
-                L->pack();
-            return L->cells[idx];
-        }
-
-        Cell& operator*()
-        {
-            if(L->dirty)
-                L->pack();
-            return *L->cells[idx];
+            return m_Cell;
         }
 
-        unsigned int GetUnsignedIdx() const
+        Cell& operator*() const
         {
-            return static_cast<unsigned int>(idx);
+            return *m_Cell;
         }
     };
-    friend Iterator;
-    Iterator begin()
+    Iterator begin() const
     {
-        return Iterator(this,0);
+        return Iterator(m_Head);
     }
-    Iterator end()
+    Iterator end() const
     {
-        return Iterator(this,cells.size());
+        return Iterator();
     }
-    bool empty()
+    bool empty() const
     {
-        if(dirty)
-            pack();
-        return cells.empty();
+        return !m_Size;
     }
-    bool size()
+    size_t size() const
     {
-        if(dirty)
-            pack();
-        return cells.size();
+        return m_Size;
     }
     // Move cell in position <posInFrom> to list <from> in <posTo>
 	void splice(Iterator posTo,CellList& from,Iterator posInFrom);
     // Move all cells <from> to <posTo>
     void splice(Iterator posTo,CellList& from);
+    // Insert cell before <pos>, end() appends
     void insertCell(Iterator,Cell&);
     void removeCell(Cell&);
+    void clear();
     Iterator find(Cell&);
 
     CellList();
+    CellList(const CellList&) = delete;
+    CellList& operator=(const CellList&) = delete;
     virtual ~CellList();
-    void TransferTo(Iterator,CellList&,bool UpdateGain=true);
+    // Cell at <it> is appended to the list given, or put at its head, <it>
+    // is not usable to continue iteration afterwards
+    void TransferTo(Iterator,CellList&,bool UpdateGain=true,bool head=false);
     void TransferAllFrom(CellList&);
-    Square GetSquare();
+    Square GetSquare() const { return m_Square; }
     std::string dbg();
     void SetCellGain(Weight gain);
-    Weight GetSumGain();
-    Weight IncrementSumGain(Weight g);
+    Cost GetSumGain();
+    Cost IncrementSumGain(Weight g);
     void InvalidateGain()
     {
         flags.GainComputed=false;
@@ -138,9 +121,8 @@ private:
     struct
     {
         bool GainComputed: 1;
-        bool SquareComputed: 1;
     } flags;
-    Weight m_SumGain;
+    Cost m_SumGain;
     Square m_Square;
 };
 
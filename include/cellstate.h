@@ -0,0 +1,53 @@
+#ifndef _CELLSTATE_H
+#define _CELLSTATE_H
+
+#include "net.h"
+#include <cstdint>
+#include <vector>
+
+namespace Novorado
+{
+	namespace Partition
+	{
+		class Partition;
+
+		// Hot per-cell algorithm state in parallel contiguous arrays indexed
+		// by cell id. Cell is a facade over one slot, so the per-move loops
+		// do not pull names, pins and links into the cache.
+		struct CellState
+		{
+			static constexpr uint8_t NoSide = 2;
+
+			std::vector<Weight> gain;
+			std::vector<uint8_t> side; // index in parts[], NoSide when unassigned
+			std::vector<bool> lock; // cell is in the locker
+			std::vector<Square> area;
+
+			Partition* parts[2]{nullptr,nullptr};
+
+			size_t size() const noexcept { return gain.size(); }
+
+			void reserve(size_t n);
+			// Heap bytes of the arrays
+			size_t Bytes() const noexcept
+			{
+				return gain.capacity()*sizeof(Weight)+side.capacity()+lock.capacity()/8+
+					area.capacity()*sizeof(Square);
+			}
+
+			// Appends a slot for a new cell and returns its index
+			size_t add();
+
+			Partition* GetPartition(size_t i) const noexcept
+			{
+				return side[i]==NoSide?nullptr:parts[side[i]];
+			}
+
+			uint8_t SideOf(const Partition* p) const;
+
+			// Changes gain of a cell and the sum of the list holding it
+			void IncrementGain(size_t i,Weight w);
+		};
+	}
+}
+#endif//_CELLSTATE_H
@@ -0,0 +1,39 @@
+#ifndef _CHECKPOINT_H
+#define _CHECKPOINT_H
+
+#include "hypergraph.h"
+
+namespace Novorado
+{
+	namespace Partition
+	{
+		/*! State of a KLFM run at a pass boundary
+		 *
+		 * Passes draw no random numbers, they only depend on the sides and on
+		 * the order of the cells in the lockers, which breaks ties between
+		 * equal gains. Both are kept as the cell ids of each locker in order;
+		 * gains are recomputed by FillBuckets on Restore().
+		 *
+		 * File layout, native byte order: "KLFMCKPT", version, widths of Index
+		 * and Weight, pass, cut, cells, left locker size, the cell ids.
+		 */
+		class Checkpoint
+		{
+			public:
+				uint32_t pass{0}; // passes completed
+				Weight cut{0}; // CutWeight() at the boundary
+				std::vector<Index> order[2]; // cells of each locker
+
+				void Capture(const NetlistHypergraph&,uint32_t pass);
+				// Sides, lockers and gains, buckets must be empty. Throws
+				// std::runtime_error if the checkpoint is of another netlist
+				void Restore(NetlistHypergraph&) const;
+
+				// Written to <fn>.tmp and renamed, a preempted write keeps the
+				// previous file. Both throw std::runtime_error
+				void Write(const string& fn) const;
+				void Read(const string& fn);
+		};
+	}
+}
+#endif//_CHECKPOINT_H
@@ -0,0 +1,62 @@
+#ifndef _COMPONENTS_H
+#define _COMPONENTS_H
+
+#include "klfm18.h"
+
+namespace Novorado
+{
+	namespace Partition
+	{
+		/*! Partitioning by connected components
+		 *
+		 * Components are found with union-find over the nets (large nets, see
+		 * NetlistHypergraph::m_LargeNetThreshold, do not connect). Components of
+		 * at least minSize cells, and those having fixed cells on both sides, are
+		 * bisected independently and in parallel. Small components are never
+		 * partitioned: they are bin-packed whole, largest first, on the lighter
+		 * side. Halves of free components are oriented the same way, so the
+		 * result keeps the SQUARE_TOLERANCE balance whenever granularity allows.
+		 * Components are bisected by KLFM::Refine, which stops at the deadline
+		 * or on cancel as KLFM runs do; components not started by then are
+		 * packed whole.
+		 */
+		class ComponentPartitioner
+		{
+			public:
+				struct Params
+				{
+					size_t minSize{8}; // smaller components are packed whole
+					unsigned int threads{0}; // 0 means hardware concurrency
+					KLFM::Clock::time_point deadline{KLFM::Clock::time_point::max()};
+					// Only its cancel is read, runs of the components do not publish
+					const Progress* progress{nullptr};
+				};
+
+				explicit ComponentPartitioner(NetlistHypergraph&);
+				ComponentPartitioner(NetlistHypergraph&,const Params&);
+
+				// Writes sides to the cells and rebuilds the lockers
+				void Partition();
+
+				size_t GetComponents() const { return m_Members.size(); }
+				// Components bisected by the last Partition()
+				size_t GetPartitioned() const { return m_Partitioned; }
+				Index GetComponent(const Cell& c) const { return m_Component[c.GetUnsignedId()]; }
+
+			private:
+				void find();
+				// Sides of the component cells, 0 or 1, in member order
+				std::vector<uint8_t> bisect(size_t comp) const;
+				// Deadline passed or cancelled
+				bool stopped() const;
+
+				NetlistHypergraph& m_Graph;
+				Params m_Params;
+
+				std::vector<Index> m_Component; // of every cell
+				std::vector<std::vector<Index>> m_Members,m_Nets; // of every component
+				size_t m_Partitioned{0};
+		};
+	}
+}
+#endif//_COMPONENTS_H
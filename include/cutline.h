@@ -48,7 +48,7 @@ namespace Novorado
 			void switchDir() noexcept
 			{
 				if(dir==Direction::Vertical) dir=Direction::Horizontal;
-					else dir=Direction::Horizontal;
+					else dir=Direction::Vertical;
 			}
 
 			//! Split
@@ -0,0 +1,74 @@
+#ifndef _DYNAMIC_H
+#define _DYNAMIC_H
+
+#include "hypergraph.h"
+
+namespace Novorado
+{
+	namespace Partition
+	{
+		/*! Incremental changes of a partitioned hypergraph (ECO)
+		 *
+		 * Keeps cells of every net on each side, the cut-net gain of every cell
+		 * and the cut weight. Every change updates them for the nets and cells
+		 * it touches only, Refine() then moves cells around the touched ones.
+		 *
+		 * Cells and nets are referred to by id, as adding them may grow the
+		 * storage (NetlistHypergraph::Grow) and invalidate references. Ids are
+		 * never reused: a removed cell stays as a disconnected fixed cell of zero
+		 * square on the left, a removed net has no pins.
+		 */
+		class DynamicHypergraph
+		{
+			public:
+				explicit DynamicHypergraph(NetlistHypergraph&);
+
+				// New cell goes to the lighter side
+				Index AddCell(const string& name,Square sq);
+				void RemoveCell(Index cell);
+				void SetSquare(Index cell,Square sq);
+
+				Index AddNet(const string& name,Weight w=1);
+				void RemoveNet(Index net);
+				void SetWeight(Index net,Weight w);
+
+				void Connect(Index cell,Index net,const string& pinName);
+				// Removes all pins of the cell on the net
+				void Disconnect(Index cell,Index net);
+
+				// Greedy moves of positive gain among the cells touched since the
+				// last call and their neighbours <radius> nets away, keeping the
+				// SQUARE_TOLERANCE balance. Returns the cut weight
+				Weight Refine(size_t radius=1);
+
+				Weight GetCut() const { return m_Cut; }
+				// Cut weight decrease if the cell moved to the other side
+				Weight GetGain(Index cell) const { return m_Gain[cell]; }
+				Index GetCount(Index net,uint8_t side) const { return m_Count[side][net]; }
+
+			private:
+				uint8_t side(Index c) const { return m_Graph.m_State.side[c]==1?1:0; }
+				Weight netCut(Index n) const;
+				Weight gain(Index c) const;
+				// Net contribution to the cut and the gains of its cells leaves
+				// before a change and gets back after
+				void detach(Index n) { contribute(n,-1); }
+				void attach(Index n) { contribute(n,1); }
+				void contribute(Index n,Weight sign);
+				void touch(Index c);
+				void move(Index c);
+
+				NetlistHypergraph& m_Graph;
+				std::vector<Index> m_Count[2]; // pins of every net on each side
+				std::vector<Weight> m_Gain;
+				std::vector<Index> m_Touched;
+				std::vector<bool> m_IsTouched;
+				// Scratch of Refine and contribute, clear between calls
+				std::vector<uint8_t> m_Mark;
+				std::vector<Index> m_Region;
+				Square m_Area[2]{0,0};
+				Weight m_Cut{0};
+		};
+	}
+}
+#endif//_DYNAMIC_H
@@ -0,0 +1,63 @@
+#ifndef _GENERATOR_H
+#define _GENERATOR_H
+
+#include "net.h"
+#include <cstdint>
+
+namespace Novorado
+{
+	namespace Partition
+	{
+		/*! Synthetic netlist with a planted bisection
+		 *
+		 * Cells are dealt to two sides at random. Every cell anchors nets of
+		 * its own side, a net of k pins takes its other pins among the
+		 * k^(1/rent) cells next to the anchor in the side order, so blocks of
+		 * B cells have about B^rent nets leaving them (Rent's rule). Net sizes
+		 * follow a power law. A given number of nets crosses the sides, and
+		 * large nets (clocks, resets) take cells all over the design. The cut of
+		 * the planted sides is known, and is an upper bound of the optimum close
+		 * to it while the crossing nets are few.
+		 *
+		 * Output is the .net format of TestBuilder, the planted sides go to a
+		 * .part file (WarmStart). Memory is linear in the cells, the nets are
+		 * streamed out, so designs of tens of millions of cells are generated.
+		 */
+		class PlantedGenerator
+		{
+			public:
+				struct Params
+				{
+					size_t cells{1000};
+					uint64_t seed{2018};
+					double netsPerCell{1.0}; // anchored at every cell, on average
+					double rent{0.6}; // Rent exponent, (0,1]
+					double exponent{2.5}; // net sizes k>=2 with P(k)~k^-exponent
+					size_t maxNetSize{32};
+					size_t cutNets{0}; // nets across the sides, 0 for cells^rent/4
+					double fixed{0.001}; // fraction of cells fixed to their planted side
+					size_t largeNets{1};
+					size_t largeNetSize{0}; // pins of a large net, 0 for cells/10
+					Square maxSquare{1}; // squares uniform in [1,maxSquare]
+				};
+
+				struct Planted
+				{
+					size_t cells{0},nets{0},pins{0},fixed{0},largeNets{0};
+					Weight cut{0}; // of the planted sides, large nets included
+					Square left{0},right{0};
+				};
+
+				// Throws std::invalid_argument on parameters out of range
+				explicit PlantedGenerator(const Params&);
+
+				// Netlist to <netFile>, planted sides to <partFile> unless empty.
+				// Throws std::runtime_error if a file cannot be written
+				Planted Write(const string& netFile,const string& partFile=string()) const;
+
+			private:
+				Params m_Params;
+		};
+	}
+}
+#endif//_GENERATOR_H
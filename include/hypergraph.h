@@ -3,6 +3,8 @@
 
 #include "solution.h"
 #include "bracket.h"
+#include "accounting.h"
+#include "policies.h"
 
 namespace Novorado
 {
@@ -10,28 +12,132 @@ namespace Novorado
 	{
 		struct NetlistHypergraph
 		{
+				// Monotonic arena of the topology: pin lists of cells and nets.
+				// Cells keep it alive, so m_AllCells may outlive the hypergraph
+				std::shared_ptr<std::pmr::monotonic_buffer_resource> m_Arena;
 				std::shared_ptr<std::vector<Cell>> m_AllCells;
+				CellState m_State; // hot state of m_AllCells
 				Novorado::Bracket<Cell> pins, instances;
 
 				NetlistHypergraph();
+				// View for a run of its own over the netlist of <g>: nets, pins,
+				// names and squares are shared and only read, the view has its own
+				// cell facades (their state and list links), lockers and buckets,
+				// starting from the sides of <g>. <g> must not change meanwhile
+				explicit NetlistHypergraph(std::shared_ptr<NetlistHypergraph> g);
 				virtual ~NetlistHypergraph();
-				std::vector<Net> nets;
+				std::vector<Net>& nets; // m_Nets, or those of the shared netlist
 				Partition p0,p1;
 				Solution bestSolution;
 
+				// Programmatic construction. Pins keep raw pointers to cells and nets,
+				// thus storage must be reserved up front and never reallocated
+				// other than by Grow()
+				void Reserve(size_t cellCnt,size_t netCnt);
+				// Reallocates storage for more cells and nets and relinks all pins.
+				// Lockers are rebuilt, references to cells and nets are invalidated.
+				// Not to be called while cells are in buckets
+				void Grow(size_t cellCnt,size_t netCnt);
+				Cell& AddCell(const string& name,Square sq,Partition* side=nullptr);
+				Net& AddNet(const string& name,Weight w=1);
+				// A pin of <count> stands for that many pins of the cell on the net
+				Pin& Connect(Cell&,Net&,const string& pinName,Index count=1);
+				// Unnamed pin, for copies that are only partitioned
+				Pin& Connect(Cell&,Net&);
+
+				// Throws std::overflow_error if the design does not fit Index,
+				// Square or Weight, call once the netlist is loaded. Gains of the
+				// nets over m_LargeNetThreshold are not bounded
+				void CheckLimits() const;
+
+				// Nets with more pins than the threshold (clock, reset, scan enable)
+				// are left out of gain computation, GetStats still reports them.
+				// 0 disables filtering
+				size_t m_LargeNetThreshold{0};
+				bool IsLargeNet(const Net& n) const noexcept
+				{
+					return m_LargeNetThreshold && n.Count()>m_LargeNetThreshold;
+				}
+
 				void InitializeLockers();
-				void FillBuckets();
-				Weight UpdateGains(Cell&);
+				// Rebuilds lockers from the sides in m_State, for engines working
+				// on the state arrays directly
+				void SyncLockers();
+				// Gains of all cells from the sides in m_State under the objective
+				// of <P>, fixed cells included
+				template<class P=DefaultPolicies> void FillBuckets();
+				// Recounts m_SidePins and m_Cost from the sides in m_State
+				template<class P=DefaultPolicies> void CountSides();
+				// Called after cell <c> changed its side, updates the gains of the
+				// cells on its nets and moves the free ones between gain lists
+				template<class P=DefaultPolicies> void UpdateGains(Cell& c);
+
+				// Pins of every net on each side, large nets included, the cost of
+				// the objective and the weight of the nets cut; kept by the three above
+				std::vector<Index> m_SidePins[2];
+				Cost m_Cost{0};
+				Cost m_CutWeight{0};
+
+				// Scratch memory of the pass loop, kept between Iteration instances
+				struct Workspace
+				{
+					// Cells hit by UpdateGains with their previous gain
+					std::vector<std::pair<Index,Weight>> touched;
+					// Cell was hit in the current UpdateGains when stamp==epoch
+					std::vector<uint32_t> stamp;
+					uint32_t epoch{0};
+
+					// O(1) unless the number of cells changed
+					void reset(size_t cells);
+					void next();
+					bool mark(Index c)
+					{
+						if(stamp[c]==epoch) return false;
+						stamp[c]=epoch;
+						return true;
+					}
+				} m_Workspace;
 
 				struct CutStat {
 					long m_NetCut;
 					Weight m_totWeight;
-					CutStat() { m_NetCut=0; m_totWeight=0; }
+					// Nets over m_LargeNetThreshold, and those of them cut
+					long m_LargeNets, m_LargeCut;
+					Weight m_LargeWeight;
+					CutStat() { m_NetCut=0; m_totWeight=0; m_LargeNets=m_LargeCut=0; m_LargeWeight=0; }
 					};
 
+				// Wall time of the last KLFM::Partition(), seconds
+				double m_PartitionTime{0};
+
 				CutStat GetStats(std::ofstream&,bool fWrite=true);
 
+				// Current bytes by subsystem. Arena and bucket peaks are exact, the
+				// other peaks are of the calls, KLFM calls it at every pass boundary
+				MemoryStats GetMemoryStats();
+				// Peaks a Partition() of the graph as it is would reach, e.g. to
+				// reject a job before it runs out of memory
+				MemoryStats EstimateRun() const;
+				// Weight of the nets on both sides from m_State, large nets included
+				Weight CutWeight() const { return CutWeight(m_State.side); }
+				// Same for the side of every cell given
+				Weight CutWeight(const std::vector<uint8_t>& sides) const;
+
 			private:
+				void setup();
+				MemoryStats current() const;
+				// Pins of cell <id>, those of the shared netlist for a view
+				std::pmr::list<Pin>& pinsOf(Index id)
+				{
+					return (m_Shared?*m_Shared->m_AllCells:*m_AllCells)[id].m_Pins;
+				}
+
+				std::vector<Net> m_Nets;
+				std::shared_ptr<NetlistHypergraph> m_Shared; // netlist of a view
+
+				// Heap of m_Arena
+				std::shared_ptr<const CountingResource> m_ArenaHeap;
+				MemoryStats m_Memory; // peaks of GetMemoryStats()
 		};
 	}
 }
@@ -0,0 +1,75 @@
+#ifndef _INITIAL_H
+#define _INITIAL_H
+
+#include "hypergraph.h"
+#include <random>
+
+namespace Novorado
+{
+	namespace Partition
+	{
+		/*! Initial partitioners, a start for KLFM::Refine()
+		 *
+		 * Every method reads the hypergraph only and is seeded explicitly, thus
+		 * runs are reproducible and may go in parallel. Fixed cells stay on their
+		 * side. The portfolio runs several methods and seeds and keeps the best
+		 * balanced solution by cut weight. RandomDistribution stays the start of
+		 * KLFM::Partition().
+		 */
+		class InitialPartitioner
+		{
+			public:
+				enum struct Method
+				{
+					Shuffle, /**< random order, every cell to the lighter side, one pass */
+					Grow, /**< breadth first region growing from a random cell */
+					GreedyGain /**< region growing by the cell cutting the least */
+				};
+
+				struct Params
+				{
+					std::vector<Method> methods{Method::Shuffle,Method::Grow,Method::GreedyGain};
+					size_t tries{4}; // seeds per method
+					uint32_t seed{2018};
+					unsigned int threads{0}; // 0 means hardware concurrency
+				};
+
+				struct Result
+				{
+					std::vector<uint8_t> sides; // 0 or 1 for every cell
+					Weight cut{0};
+					bool balanced{false};
+					Method method{Method::Shuffle};
+				};
+
+				explicit InitialPartitioner(NetlistHypergraph&);
+
+				// Single run, the graph is not changed
+				Result Run(Method,uint32_t seed) const;
+
+				// Best of the portfolio is written to the cells and the lockers
+				Result Apply(const Params&);
+				Result Apply(Method,uint32_t seed);
+
+			private:
+				using Rng = std::mt19937;
+
+				void shuffle(Result&,Rng&) const;
+				void grow(Result&,Rng&) const;
+				void greedy(Result&,Rng&) const;
+				void evaluate(Result&) const;
+				void write(const Result&);
+
+				// Free cells in random order
+				std::vector<Index> order(Rng&) const;
+
+				NetlistHypergraph& m_Graph;
+				// Distinct cells of every net and nets of every cell, large nets excluded
+				std::vector<Index> m_NetStart,m_NetCells,m_CellStart,m_CellNets;
+				std::vector<Square> m_Area;
+				std::vector<uint8_t> m_Fixed; // 0 free, 1 left, 2 right
+				Square m_Total{0},m_Largest{0}; // all cells, largest free cell
+		};
+	}
+}
+#endif//_INITIAL_H
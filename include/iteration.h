@@ -3,11 +3,17 @@
 
 #include "partition.h"
 #include "hypergraph.h"
+#include "progress.h"
+#include "journal.h"
+#include <chrono>
 
 namespace Novorado
 {
 	namespace Partition
 	{
+		// Moves between deadline checks, a power of two
+		constexpr size_t DEADLINE_CHECK_MOVES = 64;
+
 		class CellMove
 		{
 			public:
@@ -29,12 +35,24 @@ namespace Novorado
 			private:
 		};
 
+		// KLFM pass over the gain buckets of <P> (policies.h): moves every free
+		// cell once and keeps the best prefix in bestSolution. Instantiated
+		// for the bundles of policies.h
+		template<class P=DefaultPolicies>
 		class Iteration : public CellMove
 		{
 			public:
-				Iteration(NetlistHypergraph*);
+				using Clock = std::chrono::steady_clock;
+
+				Iteration(NetlistHypergraph*,Clock::time_point deadline=Clock::time_point::max(),
+					Progress* progress=nullptr,MoveJournal* journal=nullptr);
 				virtual ~Iteration();
-				Weight GetImprovement() const { return m_Improvement; }
+				Cost GetImprovement() const { return m_Improvement; }
+				// Pass stopped at the deadline, the cells are all in the lockers
+				// and the best prefix is in bestSolution
+				bool IsExpired() const { return m_Expired; }
+				// Same as expired, stopped by Progress::Cancel()
+				bool IsCancelled() const { return m_Cancelled; }
 				void moveCell(Partition*,Partition*);
 
 				void moveLeft() { moveCell(&p1,&p0); }
@@ -45,8 +63,18 @@ namespace Novorado
 		   protected:
 
 			private:
-				Weight m_Improvement;
+				// Top cell of side <from> may move under the balance policy
+				bool movable(int from);
+
+				typename P::Balance m_Balance;
+				Cost m_Improvement;
 				NetlistHypergraph* graph;
+				Clock::time_point m_Deadline;
+				bool m_Expired{false};
+				Progress* m_Progress;
+				bool m_Cancelled{false};
+				MoveJournal* m_Journal;
+				MoveJournal::Record m_Move; // last move, completed by run()
 		};
 	}
 }
@@ -0,0 +1,97 @@
+#ifndef _JOURNAL_H
+#define _JOURNAL_H
+
+#include "net.h"
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Novorado
+{
+	namespace Partition
+	{
+		/*! Binary journal of the KLFM moves, see KLFM::SetJournal()
+		 *
+		 * A record per Iteration::moveCell, written in blocks by a background
+		 * thread so the pass loop only appends to memory. File layout, native
+		 * byte order: "KLFMMOVE", version, widths of Index, Weight and Square,
+		 * size of Record, then the records.
+		 */
+		class MoveJournal
+		{
+			public:
+				struct Record
+				{
+					Index cell;
+					Weight gain; // at selection, the top of its bucket
+					Weight top[2]; // best gain left in each bucket after the move
+					Cost cut; // weight of the nets cut after the move, large ones included
+					Square square[2]; // of each side after the move
+					uint32_t pass;
+					uint8_t to; // side the cell moved to
+					uint8_t best; // move ends the best prefix so far of the pass
+				};
+
+				static constexpr size_t BlockRecords = 1u<<14;
+				// Bucket gain of an empty side
+				static constexpr Weight NoGain = std::numeric_limits<Weight>::min();
+
+				// Throws std::runtime_error if the file cannot be written
+				explicit MoveJournal(const string& fn);
+				// Flushes and stops the writer
+				virtual ~MoveJournal();
+				MoveJournal(const MoveJournal&) = delete;
+				MoveJournal& operator=(const MoveJournal&) = delete;
+
+				// Pass boundary, records carry the count
+				void NextPass() { m_Pass++; }
+				void Add(Record r)
+				{
+					r.pass=m_Pass;
+					m_Block.push_back(r);
+					if(m_Block.size()==BlockRecords) submit();
+				}
+				// Returns once every record is written, throws std::runtime_error
+				// if writing failed
+				void Flush();
+
+				struct Summary
+				{
+					struct Pass
+					{
+						size_t moves{0};
+						size_t bestPrefix{0}; // moves kept, 0 when none improved
+						Cost bestCut{0},endCut{0}; // bestCut is set with bestPrefix
+					};
+					size_t moves{0};
+					std::vector<Pass> passes;
+					std::map<Weight,size_t> gains; // at selection
+					std::map<Weight,size_t> bestGains; // of the moves in best prefixes
+				};
+
+				// Throws std::runtime_error on a file not written by this build
+				static Summary Summarize(const string& fn);
+
+			private:
+				void submit();
+				void write();
+
+				std::ofstream m_File;
+				uint32_t m_Pass{0};
+				std::vector<Record> m_Block;
+
+				std::mutex m_Mutex;
+				std::condition_variable m_Queued,m_Written;
+				std::deque<std::vector<Record>> m_Queue;
+				std::vector<std::vector<Record>> m_Spare;
+				size_t m_Busy{0}; // blocks taken by the writer
+				bool m_Stop{false},m_Failed{false};
+				std::thread m_Writer;
+		};
+	}
+}
+#endif//_JOURNAL_H
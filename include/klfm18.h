@@ -3,6 +3,11 @@
 
 #include "bin.h"
 #include "hypergraph.h"
+#include "progress.h"
+#include "checkpoint.h"
+#include "journal.h"
+#include <chrono>
+#include <future>
 
 namespace Novorado
 {
@@ -10,8 +15,6 @@ namespace Novorado
 	{
 		// Partitioner will not proceed for small bins
 		constexpr auto MIN_BIN_SIZE = 2;
-		// Square treshhold 0.1=10%
-		constexpr auto SQUARE_TOLERANCE = 0.1;
 
 		//////////////////////////////////////////////////////////////////////////////////////////
 		//
@@ -22,8 +25,56 @@ namespace Novorado
 		class KLFM : public NetlistHypergraph
 		{
 			public:
-				// Partition result is returned in last reference, it is also used as initial solution
-				void Partition();
+				KLFM() = default;
+				// Run of its own over the netlist of <g>, see NetlistHypergraph
+				explicit KLFM(std::shared_ptr<NetlistHypergraph> g):NetlistHypergraph(std::move(g)) {}
+
+				// Partition result is returned in last reference, it is also used as initial solution.
+				// Runs take the pass policies, see policies.h
+				template<class P=DefaultPolicies> void Partition();
+				// Passes from the sides the cells have, e.g. set by InitialPartitioner,
+				// the best solution found is restored
+				template<class P=DefaultPolicies> void Refine();
+
+				using Clock = std::chrono::steady_clock;
+
+				// Anytime runs: Partition() and Refine() stop between moves at the
+				// deadline or once the budget (seconds from their start) is spent,
+				// whichever comes first, and restore the best prefix of the pass
+				void SetDeadline(Clock::time_point t) { m_Deadline=t; }
+				void SetTimeBudget(double seconds) { m_Budget=seconds; }
+				Clock::time_point GetDeadline() const { return m_Deadline; }
+				// False when the last run was stopped by the time limit
+				bool IsConverged() const { return m_Converged; }
+
+				// Runs publish to <p> and stop when it is cancelled, nullptr detaches
+				void SetProgress(Progress* p) { m_Progress=p; }
+				Progress* GetProgress() const { return m_Progress; }
+				// Partition() and Refine() on a thread of their own, the result is
+				// IsConverged(). The hypergraph is not to be used until it is ready
+				std::future<bool> PartitionAsync();
+				std::future<bool> RefineAsync();
+
+				// Checkpoint written in the background at every pass boundary
+				void SetCheckpoint(const string& fn) { m_CheckpointFile=fn; }
+				// Continues the run saved in <fn> as Partition() would have
+				template<class P=DefaultPolicies> void Resume(const string& fn);
+
+				// Every move of the following runs is appended to <j>, which is
+				// flushed as a run ends, nullptr detaches
+				void SetJournal(MoveJournal* j) { m_Journal=j; }
+			private:
+				// Returns the number of passes completed
+				template<class P> uint32_t passes(Clock::time_point started,uint32_t first=0);
+				void save(uint32_t pass);
+
+				Clock::time_point m_Deadline{Clock::time_point::max()};
+				double m_Budget{-1}; // negative means no budget
+				bool m_Converged{false};
+				Progress* m_Progress{nullptr};
+				MoveJournal* m_Journal{nullptr};
+				string m_CheckpointFile;
+				std::future<void> m_Saving; // write of the previous checkpoint
 		};
 	};
 };
@@ -3,6 +3,7 @@
 
 #include "bridge.h"
 #include <vector>
+#include <memory_resource>
 
 namespace Novorado
 {
@@ -11,12 +12,12 @@ namespace Novorado
 		class Partition;
 		class Pin;
 
-		using Weight = long;
-
 		class Net : public Bridge::Id
 		{
 			public:
 				Net();
+				// Pin lists are allocated from <arena>
+				explicit Net(std::pmr::memory_resource* arena);
 				virtual ~Net();
 				Net(const Net& other);
 				Net& operator=(const Net& other);
@@ -29,16 +30,31 @@ namespace Novorado
 					return m_Weight;
 				}
 				void AddPin(Pin*);
+				// Removes the pins of cell <id>, returns how many there were
+				size_t RemovePins(Index id);
+				void Reserve(size_t pins)
+				{
+					m_Pins.reserve(pins);
+					m_CellIds.reserve(pins);
+				}
 				auto Dim() const
 				{
 					return m_Pins.size();
 				}
 				auto Dim(Partition*);
-				std::vector<Pin*> m_Pins;
+				// Pins the net stands for, Dim() unless pins have counts
+				size_t Count() const { return m_Count; }
+				// Count of the pin <k>
+				Index Count(size_t k) const { return m_PinCounts.empty()?1:m_PinCounts[k]; }
+				std::pmr::vector<Pin*> m_Pins;
+				std::pmr::vector<Index> m_CellIds; // cell of every pin, for the hot loops
+				// Pin::GetCount() of every pin, empty while all are 1
+				std::pmr::vector<Index> m_PinCounts;
 
 			protected:
 			private:
 				Weight m_Weight;
+				size_t m_Count{0};
 		};
 	}
 }
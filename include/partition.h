@@ -19,7 +19,7 @@ namespace Novorado
 				Bucket m_Bucket;
 
 				Square GetSquare();
-				Weight GetGain();
+				Cost GetGain();
 
 				void preset(const std::vector<Cell*>& fix,const std::vector<Cell*>& ini);
 
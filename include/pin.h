@@ -28,6 +28,10 @@ namespace Novorado
 
 			void SetNet(Net* val) noexcept;
 
+			// Pins the pin stands for, e.g. a terminal for several fixed cells
+			Index GetCount() const noexcept { return m_Count; }
+			void SetCount(Index n) noexcept { m_Count=n; }
+
 			#ifdef CHECK_LOGIC
 			// Overloading object method for consistency checking
 			virtual void SetName(const std::string&);
@@ -35,8 +39,9 @@ namespace Novorado
 
 		protected:
 		private:
-			Cell* m_Cell;
-			Net* m_Net;
+			Cell* m_Cell{nullptr};
+			Net* m_Net{nullptr};
+			Index m_Count{1};
 		};
 	}
 }
@@ -0,0 +1,81 @@
+#ifndef _PLACER_H
+#define _PLACER_H
+
+#include "klfm18.h"
+#include <functional>
+
+namespace Novorado
+{
+	namespace Partition
+	{
+		/*! Recursive min-cut global placer
+		 *
+		 * Die rectangle is cut recursively with alternating cutline direction,
+		 * every region is bisected with KLFM. Cells outside of the region sharing
+		 * a net with it are propagated as fixed terminals to the nearer side.
+		 * Regions of the same level are independent and partitioned in parallel.
+		 * Every region is bisected by a seeded InitialPartitioner and
+		 * KLFM::Refine(), the seed follows from the level and the region index,
+		 * so placements do not depend on the number of threads.
+		 */
+		class MinCutPlacer
+		{
+			public:
+				/** Cut scheme */
+				enum struct Mode
+				{
+					Bisection, /**< one cut per region per level */
+					Quadrisection /**< both cuts per region per level */
+				};
+
+				struct Params
+				{
+					Mode mode{Mode::Bisection};
+					CutLine::Direction firstCut{CutLine::Direction::Vertical};
+					size_t leafSize{MIN_BIN_SIZE}; // regions this small are not cut
+					unsigned int threads{0}; // 0 means hardware concurrency
+					uint32_t seed{2018};
+				};
+
+				MinCutPlacer(NetlistHypergraph&,const Bridge::Rect& die);
+				MinCutPlacer(NetlistHypergraph&,const Bridge::Rect& die,const Params&);
+
+				void Place();
+
+				//! Region assigned to the cell, indexed by cell id
+				const Bridge::Rect& GetRegion(const Cell& c) const
+				{
+					return m_Regions[c.GetUnsignedId()];
+				}
+				const std::vector<Bridge::Rect>& GetRegions() const { return m_Regions; }
+
+				Coordinate GetX(const Cell& c) const { return GetRegion(c).hCenter(); }
+				Coordinate GetY(const Cell& c) const { return GetRegion(c).vCenter(); }
+
+				// Number of recursion levels performed by the last Place()
+				size_t GetLevels() const { return m_Levels; }
+
+			private:
+				struct Region
+				{
+					Bridge::Rect box;
+					std::vector<Cell*> cells;
+					CutLine::Direction dir;
+					uint32_t seed{0}; // of the subproblem
+				};
+
+				using Lookup = std::function<const Bridge::Rect&(const Cell&)>;
+
+				// Bisects region, <pos> is the cell region lookup used for terminals
+				bool bisect(const Region&,const Lookup& pos,part& result) const;
+				std::vector<Region> cut(const Region&) const;
+
+				NetlistHypergraph& m_Graph;
+				Bridge::Rect m_Die;
+				Params m_Params;
+				std::vector<Bridge::Rect> m_Regions;
+				size_t m_Levels{0};
+		};
+	}
+}
+#endif//_PLACER_H
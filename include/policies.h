@@ -0,0 +1,137 @@
+#ifndef _POLICIES_H
+#define _POLICIES_H
+
+#include "cellstate.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace Novorado
+{
+	namespace Partition
+	{
+		// Square treshhold 0.1=10%
+		constexpr auto SQUARE_TOLERANCE = 0.1;
+
+		//////////////////////////////////////////////////////////////////////////////////////////
+		//
+		// Policies of the KLFM pass engine: Iteration, with the gains kept by
+		// NetlistHypergraph::FillBuckets/UpdateGains. Policies not selected are
+		// not compiled in, the hot loops are not virtual
+		//
+		//////////////////////////////////////////////////////////////////////////////////////////
+
+		// Weight model: net weights as loaded
+		struct NetWeights
+		{
+			static Weight weight(const Net& n) noexcept { return n.GetWeight(); }
+		};
+
+		// Weight model: every net weighs 1, multiplications fold away
+		struct UnitWeights
+		{
+			static constexpr Weight weight(const Net&) noexcept { return 1; }
+		};
+
+		// Objectives, gain() is the contribution of one pin of a net to the gain
+		// of its cell, with <same> pins of the net on the cell side (the pin
+		// itself included) and <other> on the other one. cost() is the
+		// contribution of the net, the cost minimized is their sum
+
+		// Objective: weight of the pin pairs across the cut, up to a constant;
+		// the cost is the sum of cell gains. The model KLFM minimizes
+		struct PinPairs
+		{
+			static constexpr Weight gain(Index same,Index other,Weight w) noexcept
+			{
+				return w*(static_cast<Weight>(other)-static_cast<Weight>(same)+1);
+			}
+			static constexpr Cost cost(Index c0,Index c1,Weight w) noexcept
+			{
+				const Cost d=static_cast<Cost>(c0)-static_cast<Cost>(c1);
+				return w*(static_cast<Cost>(c0)+static_cast<Cost>(c1)-d*d);
+			}
+		};
+
+		// Objective: weight of the nets having pins on both sides (classic FM).
+		// Exact for nets with a pin per cell
+		struct CutNets
+		{
+			static constexpr Weight gain(Index same,Index other,Weight w) noexcept
+			{
+				return (same==1?w:0)-(other==0?w:0);
+			}
+			static constexpr Cost cost(Index c0,Index c1,Weight w) noexcept
+			{
+				return c0&&c1?w:0;
+			}
+		};
+
+		// Balance: a side larger than (1+tolerance) of the other one has to
+		// give cells away, any move is legal and any best prefix is taken
+		struct AreaTolerance
+		{
+			double tolerance{SQUARE_TOLERANCE};
+
+			void init(const CellState&) noexcept {}
+			// Side forced to move a cell, -1 if free to choose by gain
+			int forced(Square a0,Square a1) const noexcept
+			{
+				if(a0>(1.0+tolerance)*a1) return 0;
+				if(a1>(1.0+tolerance)*a0) return 1;
+				return -1;
+			}
+			bool legal(Square /*to*/,Square /*cell*/) const noexcept { return true; }
+			bool accept(Square /*a0*/,Square /*a1*/) const noexcept { return true; }
+		};
+
+		// Balance: hard bound on each side, total/2 plus tolerance (at least
+		// the largest cell). Moves beyond it are rejected, prefixes beyond it
+		// are not taken
+		struct StrictBound
+		{
+			double tolerance{SQUARE_TOLERANCE};
+			Square upper{0};
+
+			void init(const CellState& s) noexcept
+			{
+				Square total=0,largest=0;
+				for(Square a:s.area)
+				{
+					total+=a;
+					largest=std::max(largest,a);
+				}
+				upper=total/2+std::max(static_cast<Square>(total*tolerance/2),largest);
+			}
+			int forced(Square a0,Square a1) const noexcept
+			{
+				if(a0>upper) return 0;
+				if(a1>upper) return 1;
+				return -1;
+			}
+			bool legal(Square to,Square cell) const noexcept { return to+cell<=upper; }
+			bool accept(Square a0,Square a1) const noexcept { return a0<=upper && a1<=upper; }
+		};
+
+		// Tie-breaking among cells of equal gain, the head of a gain list moves
+		// first: Fifo appends updated cells, Lifo puts them at the head
+		struct Fifo { static constexpr bool head = false; };
+		struct Lifo { static constexpr bool head = true; };
+
+		template<class W=NetWeights,class O=PinPairs,class B=AreaTolerance,class T=Fifo>
+		struct Policies
+		{
+			using Weights = W;
+			using Objective = O;
+			using Balance = B;
+			using Tie = T;
+		};
+
+		// Bundles Iteration, FillBuckets and the KLFM runs are instantiated for
+		using DefaultPolicies = Policies<>;
+		// Unit nets: gains are pin counts
+		using UnitPolicies = Policies<UnitWeights>;
+		// Classic FM: cut nets under a hard balance bound
+		using CutPolicies = Policies<NetWeights,CutNets,StrictBound,Lifo>;
+	}
+}
+#endif//_POLICIES_H
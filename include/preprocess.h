@@ -0,0 +1,77 @@
+#ifndef _PREPROCESS_H
+#define _PREPROCESS_H
+
+#include "hypergraph.h"
+
+namespace Novorado
+{
+	namespace Partition
+	{
+		/*! Hypergraph reduction before partitioning
+		 *
+		 * Nets with less than two distinct cells can never be cut and are
+		 * removed. Nets with the same cell set are merged into one carrying the
+		 * sum of weights, found by hashing sorted cell sets. Optionally cells
+		 * with the same net signature (and the same fixed side) are contracted
+		 * into one cell of the total square. Fixed cells of each side may be
+		 * collapsed into a single super-terminal, nets get one pin on it whose
+		 * count (Pin::GetCount) is the number of fixed cells collapsed, so the
+		 * gain loops scan one entry where they scanned one per pad.
+		 *
+		 * The cut weight of any partition of the reduced hypergraph equals the
+		 * cut weight of the original one with the partition written back. With
+		 * collapseFixed alone the free cells also keep their gains, areas and
+		 * order, thus KLFM moves the same cells on both hypergraphs as long as
+		 * no cell has two pins on a net. Clustering keeps cut and area only.
+		 */
+		class Preprocessor
+		{
+			public:
+				struct Params
+				{
+					bool clusterCells{false}; // contract cells of identical signature
+					bool collapseFixed{false}; // one terminal per side for fixed cells
+				};
+
+				struct Stats
+				{
+					size_t singlePinNets{0}; // removed, less than two cells
+					size_t parallelNets{0}; // merged into another net
+					size_t clusteredCells{0}; // contracted into another cell
+					size_t collapsedFixed{0}; // fixed cells merged into a terminal
+					size_t pinsBefore{0},pinsAfter{0}; // pins scanned, not counts
+				};
+
+				explicit Preprocessor(NetlistHypergraph&);
+				Preprocessor(NetlistHypergraph&,const Params&);
+
+				// Fills empty <to> with the reduced hypergraph
+				void Build(NetlistHypergraph& from,NetlistHypergraph& to) const;
+
+				// Copies partition of reduced cells back to the original ones
+				void WriteBack(NetlistHypergraph& reduced,NetlistHypergraph& original) const;
+
+				// Reduced id of the original cell
+				Index ReducedCell(Index i) const { return m_CellMap[i]; }
+				// Reduced id of the original net, InvalidIndex if removed
+				Index ReducedNet(Index i) const { return m_NetMap[i]; }
+
+				const Stats& GetStats() const { return m_Stats; }
+
+			private:
+				void cluster(NetlistHypergraph&,const std::vector<std::vector<Index>>& netCells);
+
+				Params m_Params;
+				Stats m_Stats;
+
+				std::vector<Index> m_CellMap,m_NetMap;
+				// Representative original cell of every reduced cell
+				std::vector<Index> m_Cells;
+				// Cells and weight of every reduced net
+				std::vector<std::vector<Index>> m_NetCells;
+				std::vector<Weight> m_NetWeights;
+				std::vector<Index> m_NetNames; // original net giving the name
+		};
+	}
+}
+#endif//_PREPROCESS_H
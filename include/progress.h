@@ -0,0 +1,63 @@
+#ifndef _PROGRESS_H
+#define _PROGRESS_H
+
+#include "net.h"
+#include <atomic>
+#include <cstdint>
+
+namespace Novorado
+{
+	namespace Partition
+	{
+		/*! Progress of a running KLFM, shared with other threads
+		 *
+		 * The run is the only writer and never waits: every field is an atomic
+		 * guarded by a sequence counter, Get() retries while a write is in
+		 * flight and returns a consistent copy. Cancel() is checked before
+		 * every move, the run then stops as at its deadline.
+		 */
+		class Progress
+		{
+			public:
+				struct Snapshot
+				{
+					Cost cost{0}; // sum of gains minimized, best of the current pass
+					Weight cut{0}; // cut weight at the last pass boundary
+					Square left{0},right{0}; // sides of the best solution
+					uint32_t pass{0}; // passes completed
+					bool running{false};
+				};
+
+				void Cancel() noexcept { m_Cancelled.store(true,std::memory_order_relaxed); }
+				bool IsCancelled() const noexcept
+				{
+					return m_Cancelled.load(std::memory_order_relaxed) || (m_Parent && m_Parent->IsCancelled());
+				}
+				// Cancel() of <parent> cancels this one too, e.g. for the runs of
+				// the parts of a problem. Set before the run, nullptr detaches
+				void Follow(const Progress* parent) noexcept { m_Parent=parent; }
+				// Clears the cancellation before the next run
+				void Reset() noexcept { m_Cancelled.store(false,std::memory_order_relaxed); }
+
+				Snapshot Get() const noexcept;
+
+				// Writer side, called by the run only
+				void Best(Cost cost,Square left,Square right) noexcept;
+				void Pass(uint32_t pass,Weight cut,bool running) noexcept;
+
+			private:
+				void publish() noexcept;
+
+				Snapshot m_Last; // writer copy
+				std::atomic<bool> m_Cancelled{false};
+				const Progress* m_Parent{nullptr};
+				std::atomic<uint32_t> m_Seq{0}; // odd while writing
+				std::atomic<Cost> m_Cost{0};
+				std::atomic<Weight> m_Cut{0};
+				std::atomic<Square> m_Left{0},m_Right{0};
+				std::atomic<uint32_t> m_Pass{0};
+				std::atomic<bool> m_Running{false};
+		};
+	}
+}
+#endif//_PROGRESS_H
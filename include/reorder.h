@@ -0,0 +1,56 @@
+#ifndef _REORDER_H
+#define _REORDER_H
+
+#include "hypergraph.h"
+
+namespace Novorado
+{
+	namespace Partition
+	{
+		/*! Cache locality reordering of a loaded hypergraph
+		 *
+		 * Cell and net ids follow the input file, thus cells sharing a net are
+		 * scattered over m_AllCells and CellState. Reordering computes a new
+		 * numbering where connected cells are close, and builds a renumbered copy
+		 * of the hypergraph, all per-cell and per-net arrays follow the new ids.
+		 * Names are kept, original ids are available through the mapping and the
+		 * partition found on the copy is written back with WriteBack().
+		 */
+		class Reordering
+		{
+			public:
+				enum struct Method
+				{
+					BFS, /**< breadth first over nets from a low degree cell */
+					RCM, /**< reverse Cuthill-McKee, neighbours by increasing degree */
+					NetSorted /**< nets by size, cells by first appearance */
+				};
+
+				Reordering(NetlistHypergraph&,Method);
+
+				// Fills empty <to> with the renumbered copy of the hypergraph
+				// the ordering was computed for, sides and fixed flags included
+				void Build(NetlistHypergraph& from,NetlistHypergraph& to) const;
+
+				// Copies partition of renumbered cells back to the original ones
+				void WriteBack(NetlistHypergraph& reordered,NetlistHypergraph& original) const;
+
+				// Original id of the cell/net with the new id
+				Index OriginalCell(Index i) const { return m_CellOrder[i]; }
+				Index OriginalNet(Index i) const { return m_NetOrder[i]; }
+
+				// New id -> original id
+				const std::vector<Index>& GetCellOrder() const { return m_CellOrder; }
+				const std::vector<Index>& GetNetOrder() const { return m_NetOrder; }
+
+			private:
+				void traverse(NetlistHypergraph&,bool rcm);
+				void netSorted(NetlistHypergraph&);
+				// Nets by the smallest new id of their cells
+				void orderNets(NetlistHypergraph&);
+
+				std::vector<Index> m_CellOrder,m_NetOrder;
+		};
+	}
+}
+#endif//_REORDER_H
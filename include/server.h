@@ -0,0 +1,155 @@
+#ifndef _SERVER_H
+#define _SERVER_H
+
+#include "klfm18.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+
+namespace Novorado
+{
+	namespace Partition
+	{
+		/*! Partition server keeping netlists resident between requests
+		 *
+		 * Frames both ways are a uint32 payload size and the payload, numbers in
+		 * native byte order. A request is a uint32 id, a uint8 Op and its fields,
+		 * a response the id, a uint8 status (0 ok) and the result or an error
+		 * message. Strings are a uint32 size and the bytes, weights are int64,
+		 * sides are a uint64 cell count and a bit per cell, set for the right.
+		 *
+		 *  Load      name, path                    -> cells u64, nets u64
+		 *  Partition name, seed u32, budget f64    -> cut, converged u8, sides
+		 *  WarmStart name, budget f64, sides       -> cut, converged u8, sides
+		 *  Reweight  name, count u32, (net u32, weight)* -> nothing
+		 *  Cut       name, sides                   -> cut
+		 *
+		 * Requests of all connections run on a pool of workers, responses come
+		 * as they are ready; a connection stops reading while the queue is full.
+		 * Partitioning runs on a view of the resident netlist (KLFM over a
+		 * shared NetlistHypergraph), so a job in flight holds only cell facades,
+		 * state and buckets of its own. No file is parsed again; Reweight takes
+		 * all its weights or none, rejecting those that fail CheckLimits, and
+		 * waits for the requests reading that netlist.
+		 */
+		class PartitionServer
+		{
+			public:
+				enum struct Op : uint8_t { Load=1, Partition, WarmStart, Reweight, Cut };
+
+				using Loader = std::function<std::shared_ptr<KLFM>(const string&)>;
+
+				// <threads> workers, 0 means hardware concurrency
+				explicit PartitionServer(Loader,unsigned int threads=0);
+				~PartitionServer();
+
+				void Add(const string& name,std::shared_ptr<KLFM>);
+
+				// Serves the frames of <in> until its end, then waits for the
+				// requests in flight
+				void Serve(std::istream& in,std::ostream& out);
+				// Serves descriptors, a connected socket is given twice, and closes them
+				void Serve(int in,int out);
+				// Listens on a Unix domain socket, serving every connection on a
+				// thread of its own. Returns after <connections> of them, 0 never
+				void ServeUnix(const string& path,size_t connections=0);
+
+			private:
+				struct Resident
+				{
+					std::shared_ptr<KLFM> graph;
+					std::shared_mutex lock; // exclusive for Reweight
+				};
+
+				// Stream a request came from, its responses go out in turn
+				struct Connection
+				{
+					std::ostream& out;
+					std::mutex writing;
+					size_t inflight{0}; // guarded by m_QueueMutex
+				};
+
+				struct Job
+				{
+					string request;
+					Connection* from{nullptr};
+				};
+
+				std::shared_ptr<Resident> find(const string& name);
+				string handle(const string& request);
+				void work();
+
+				Loader m_Loader;
+				std::shared_mutex m_Mutex; // of m_Netlists
+				std::map<string,std::shared_ptr<Resident>> m_Netlists;
+
+				std::mutex m_QueueMutex;
+				std::condition_variable m_Ready,m_Space,m_Done;
+				std::deque<Job> m_Queue;
+				size_t m_QueueLimit{0};
+				bool m_Stop{false};
+				std::vector<std::thread> m_Workers;
+		};
+
+		//! Stream buffer over a file descriptor, which is not closed
+		class FdBuf : public std::streambuf
+		{
+			public:
+				explicit FdBuf(int fd);
+				virtual ~FdBuf();
+
+			protected:
+				int_type underflow() override;
+				int_type overflow(int_type c) override;
+				int sync() override;
+
+			private:
+				int m_Fd;
+				char m_In[4096],m_Out[4096];
+		};
+
+		//! Stand-in client, e.g. for tests and scripts
+		class PartitionClient
+		{
+			public:
+				struct Response
+				{
+					uint32_t id{0};
+					PartitionServer::Op op{PartitionServer::Op::Load};
+					bool ok{false};
+					string error;
+					uint64_t cells{0},nets{0}; // Load
+					Weight cut{0};
+					bool converged{false};
+					std::vector<uint8_t> sides; // 0 or 1 for every cell
+				};
+
+				PartitionClient(std::istream& in,std::ostream& out);
+
+				// Requests return their id, frames are flushed at once
+				uint32_t Load(const string& name,const string& path);
+				uint32_t Partition(const string& name,uint32_t seed,double budget=-1);
+				uint32_t WarmStart(const string& name,const std::vector<uint8_t>& sides,double budget=-1);
+				// Weights go as int64, the server rejects those that do not fit
+				uint32_t Reweight(const string& name,const std::vector<std::pair<Index,int64_t>>& weights);
+				uint32_t Cut(const string& name,const std::vector<uint8_t>& sides);
+
+				// Next response, throws std::runtime_error at the end of the stream
+				Response Read();
+
+			private:
+				uint32_t send(PartitionServer::Op,const string& fields);
+
+				std::istream& m_In;
+				std::ostream& m_Out;
+				uint32_t m_Next{1};
+				std::map<uint32_t,PartitionServer::Op> m_Pending;
+		};
+	}
+}
+#endif//_SERVER_H
@@ -16,7 +16,7 @@ namespace Novorado
 					Weight gain;
 					Partition* p;
 					};
-				Solution(Partition&,Partition&,std::vector<Cell>&);
+				Solution(Partition&,Partition&,std::vector<Cell>&,Cost);
 				Solution(Partition&,Partition&);
 				virtual ~Solution();
 
@@ -30,24 +30,29 @@ namespace Novorado
 					return float(std::max(s1,s2)) / float(std::min(s1,s2));
 				}
 
-				// Quality of the solution
-				Weight Cut() const { return g1+g2; }
+				// Quality of the solution, the objective cost it was captured with
+				Cost Cut() const { return m_Cost; }
 
 				void AddCell(Cell*);
 
+				// Records all cells and the cost of their sides, reusing the storage
+				// of the previous record
+				void Capture(std::vector<Cell>&,Cost);
+				size_t Bytes() const noexcept { return m_Recs.capacity()*sizeof(CellRecord); }
+
 				static bool SolutionImproved(
 					Solution&,
 
 					Square s2_0,
 					Square s2_1,
-					Weight g2);
+					Cost g2);
 
 				// Interchanges cells in lockers and initializes gain
 				void WriteLockers(CellList& l0, CellList& l1);
 
 			protected:
 				Partition *p1, *p2;
-				Weight g1,g2;
+				Cost m_Cost;
 				Square s1,s2;
 				std::vector<CellRecord> m_Recs;
 		};
@@ -16,9 +16,8 @@ namespace Novorado {
 
 				Pin &getNextPin(Cell &c1, const std::string &name="");
 
-				void MakeCell(const std::string &cellName,
-							  const std::string &ssq,
-							  unsigned int &idx );
+				Cell &MakeCell(const std::string &cellName,
+							   const std::string &ssq);
 
 				void MakeNet(Net &net,
 							 const std::vector<std::string> &words,
@@ -0,0 +1,60 @@
+#ifndef _TRACE_H
+#define _TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+// Scoped begin/end events of the library phases, built with -DKLFM_TRACE
+// (make TRACE=1). Without it KLFM_TRACE_SCOPE compiles to nothing
+#ifdef KLFM_TRACE
+#define KLFM_TRACE_CAT(a,b) a##b
+#define KLFM_TRACE_VAR(l) KLFM_TRACE_CAT(klfmTraceScope,l)
+#define KLFM_TRACE_SCOPE(name) Novorado::Partition::Trace::Scope KLFM_TRACE_VAR(__LINE__)(name)
+#else
+#define KLFM_TRACE_SCOPE(name) ((void)0)
+#endif
+
+namespace Novorado
+{
+	namespace Partition
+	{
+		/*! Timeline of the library phases in Chrome trace format
+		 *
+		 * Every thread records into a ring buffer of its own, so recording
+		 * takes no lock: a clock read and two relaxed stores. The oldest
+		 * events are overwritten when a buffer is full. Buffers of finished
+		 * threads are kept for Dump(), the latest RetiredBuffers of them.
+		 * Names must be string literals or otherwise outlive the dump.
+		 */
+		class Trace
+		{
+			public:
+				static constexpr size_t BufferEvents = 1u<<16;
+				static constexpr size_t RetiredBuffers = 64;
+
+				class Scope
+				{
+					public:
+						explicit Scope(const char* name) : m_Name(name) { Begin(m_Name); }
+						~Scope() { End(m_Name); }
+						Scope(const Scope&) = delete;
+						Scope& operator=(const Scope&) = delete;
+					private:
+						const char* m_Name;
+				};
+
+				static void Begin(const char* name);
+				static void End(const char* name);
+
+				// JSON for chrome://tracing or Perfetto, events of all threads.
+				// May run while other threads record
+				static void Dump(std::ostream&);
+				static void Dump(const std::string& fn);
+				// Drops the events recorded so far
+				static void Clear();
+		};
+	}
+}
+#endif//_TRACE_H
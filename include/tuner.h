@@ -0,0 +1,77 @@
+#ifndef _TUNER_H
+#define _TUNER_H
+
+#include "klfm18.h"
+#include "initial.h"
+
+namespace Novorado
+{
+	namespace Partition
+	{
+		//! Shape of a hypergraph, one pass over cells and nets
+		struct HypergraphStats
+		{
+			struct Distribution
+			{
+				size_t p50{0},p90{0},p99{0},max{0};
+				double mean{0};
+			};
+
+			size_t cells{0},nets{0},pins{0},fixed{0};
+			double fixedRatio{0};
+			Distribution degree; // pins of a cell
+			Distribution netSize; // pins of a net
+			size_t singlePinNets{0};
+			Square minSquare{0},maxSquare{0};
+			Weight minWeight{0},maxWeight{0};
+			// Connected by the nets within the large net threshold of the hypergraph
+			size_t components{0},largestComponent{0};
+
+			static HypergraphStats Compute(const NetlistHypergraph&);
+		};
+
+		/*! Run configuration chosen from HypergraphStats
+		 *
+		 * Nets far larger than the bulk (clock, reset) leave the gains, designs
+		 * made of several pieces, none holding most of the cells, are split by
+		 * ComponentPartitioner (whole when packing alone keeps the balance),
+		 * otherwise the InitialPartitioner portfolio is sized by the design.
+		 * Either way KLFM::Refine() finishes. Trial() runs
+		 * each initial method once and keeps the ones close to the best.
+		 */
+		class Tuner
+		{
+			public:
+				enum struct Strategy
+				{
+					Portfolio, /**< InitialPartitioner, then Refine() */
+					Components /**< ComponentPartitioner, then Refine() */
+				};
+
+				struct Config
+				{
+					Strategy strategy{Strategy::Portfolio};
+					size_t largeNetThreshold{0};
+					size_t minComponent{8}; // ComponentPartitioner::Params::minSize
+					InitialPartitioner::Params initial;
+					unsigned int threads{0}; // 0 means hardware concurrency
+					double budget{-1}; // seconds for the initial partition and Refine, negative for none
+				};
+
+				explicit Tuner(KLFM&);
+
+				const HypergraphStats& GetStats() const { return m_Stats; }
+
+				Config Choose() const;
+				// Methods of the portfolio pruned by a single run of each, the
+				// large net threshold of the config is set as Apply() would
+				Config Trial(Config);
+				void Apply(const Config&);
+
+			private:
+				KLFM& m_Graph;
+				HypergraphStats m_Stats;
+		};
+	}
+}
+#endif//_TUNER_H
@@ -0,0 +1,47 @@
+#ifndef _WARMSTART_H
+#define _WARMSTART_H
+
+#include "hypergraph.h"
+#include <unordered_map>
+
+namespace Novorado
+{
+	namespace Partition
+	{
+		/*! Initial assignment from a previous run
+		 *
+		 * Reads either the <design>_left/<design>_right lists written after
+		 * partitioning (a cell name per line), or a .part file with a
+		 * "<cell> <0|1>" line per cell. Cells are matched by name. Apply()
+		 * sets the sides, then KLFM::Refine() runs refinement only. Cells absent
+		 * from the solution (added since) go to the lighter side, fixed cells
+		 * always keep their own side.
+		 */
+		class WarmStart
+		{
+			public:
+				explicit WarmStart(NetlistHypergraph&);
+
+				void ReadLockers(const string& left,const string& right);
+				void ReadPart(const string& fn);
+				// Current sides of the hypergraph in .part format
+				void WritePart(const string& fn) const;
+
+				// Writes sides to the cells and rebuilds the lockers
+				void Apply();
+
+				size_t GetMatched() const { return m_Matched; }
+				// Names of the solution not found in the hypergraph
+				size_t GetUnknown() const { return m_Unknown; }
+
+			private:
+				void set(const string& name,uint8_t side);
+
+				NetlistHypergraph& m_Graph;
+				std::unordered_map<string,Index> m_Names;
+				std::vector<uint8_t> m_Sides; // CellState::NoSide when not in the solution
+				size_t m_Matched{0},m_Unknown{0};
+		};
+	}
+}
+#endif//_WARMSTART_H
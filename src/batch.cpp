@@ -0,0 +1,230 @@
+#include "batch.h"
+#include "trace.h"
+#include "initial.h"
+#include "warmstart.h"
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+using namespace Novorado::Partition;
+
+namespace
+{
+	string quoted(const string& s)
+	{
+		std::stringstream rv;
+		rv << '"';
+		for(char c:s)
+		{
+			if(c=='"' || c=='\\') rv << '\\' << c;
+			else if(static_cast<unsigned char>(c)<0x20)
+				rv << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c) << std::dec;
+			else rv << c;
+		}
+		rv << '"';
+		return rv.str();
+	}
+}
+
+BatchRunner::BatchRunner(Loader loader,const Params& params):
+	m_Loader(std::move(loader)),m_Params(params)
+{
+	if(!params.cache.empty()) m_Cache=std::make_unique<ResultCache>(params.cache);
+}
+
+ResultCache::Stats BatchRunner::GetCacheStats() const
+{
+	return m_Cache?m_Cache->GetStats():ResultCache::Stats();
+}
+
+void BatchRunner::ReadManifest(const string& fn)
+{
+	std::ifstream f(fn);
+	if(!f) throw std::runtime_error("Cannot open manifest '"+fn+"'");
+
+	long ln=0;
+	for(string l;std::getline(f,l);)
+	{
+		ln++;
+		l=l.substr(0,l.find('#'));
+		std::stringstream s(l);
+		Job job;
+		if(!(s >> job.input)) continue;
+
+		for(string kv;s >> kv;)
+		{
+			const auto eq=kv.find('=');
+			const string key=kv.substr(0,eq), value=eq==string::npos?"":kv.substr(eq+1);
+			std::stringstream v(value);
+			bool good=!value.empty();
+			if(key=="output") job.output=value;
+			else if(key=="seed") good=good && (v >> job.seed);
+			else if(key=="budget") good=good && (v >> job.budget);
+			else if(key=="large") good=good && (v >> job.large);
+			else good=false;
+
+			if(!good || (key!="output" && !v.eof()))
+			{
+				std::stringstream msg;
+				msg << "Wrong parameter '" << kv << "' at " << fn << ":" << ln;
+				throw std::runtime_error(msg.str());
+			}
+		}
+		m_Jobs.push_back(job);
+	}
+}
+
+void BatchRunner::admit(size_t bytes)
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_Admitted.wait(lock,[&]{ return !m_Params.memory || !m_InUse || m_InUse+bytes<=m_Params.memory; });
+	m_InUse+=bytes;
+}
+
+void BatchRunner::release(size_t bytes)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_InUse-=bytes;
+	}
+	m_Admitted.notify_all();
+}
+
+void BatchRunner::run(const Job& job,Result& r)
+{
+	KLFM_TRACE_SCOPE("BatchRunner::run");
+	using Clock = KLFM::Clock;
+
+	std::ifstream probe(job.input,std::ios::binary|std::ios::ate);
+	if(!probe) throw std::runtime_error("Cannot open netlist '"+job.input+"'");
+	r.memory=static_cast<size_t>(probe.tellg())*MemoryPerInputByte;
+	probe.close();
+
+	admit(r.memory);
+	try
+	{
+		auto started=Clock::now();
+		std::shared_ptr<KLFM> g=m_Loader(job.input);
+		g->m_LargeNetThreshold=job.large;
+		r.cells=g->m_AllCells->size();
+		r.nets=g->nets.size();
+		r.loadTime=std::chrono::duration<double>(Clock::now()-started).count();
+
+		if(m_Params.limit)
+		{
+			const size_t peak=g->EstimateRun().Peak();
+			if(peak>m_Params.limit)
+			{
+				throw std::runtime_error("Partitioning '"+job.input+"' takes "+std::to_string(peak)+
+					" bytes, over the limit of "+std::to_string(m_Params.limit));
+			}
+		}
+
+		started=Clock::now();
+		string key;
+		if(m_Cache)
+		{
+			key=ResultCache::Key(*g,"initial+refine seed="+std::to_string(job.seed));
+			r.cached=m_Cache->Load(*g,key);
+		}
+		if(!r.cached)
+		{
+			InitialPartitioner::Params ip;
+			ip.seed=job.seed;
+			ip.threads=1; // jobs are the unit of parallelism
+			InitialPartitioner(*g).Apply(ip);
+			g->SetTimeBudget(job.budget);
+			g->Refine();
+			if(m_Cache && g->IsConverged()) m_Cache->Store(*g,key);
+		}
+		r.partitionTime=std::chrono::duration<double>(Clock::now()-started).count();
+
+		r.converged=r.cached || g->IsConverged();
+		r.cut=g->CutWeight();
+		r.left=g->p0.m_Locker.GetSquare();
+		r.right=g->p1.m_Locker.GetSquare();
+		r.peakMemory=g->GetMemoryStats().Peak();
+		if(!job.output.empty()) WarmStart(*g).WritePart(job.output);
+		r.ok=true;
+	}
+	catch(...)
+	{
+		release(r.memory);
+		throw;
+	}
+	release(r.memory);
+}
+
+const std::vector<BatchRunner::Result>& BatchRunner::Run()
+{
+	m_Results.assign(m_Jobs.size(),Result());
+
+	unsigned int threads=m_Params.threads;
+	if(!threads) threads=std::max(1u,std::thread::hardware_concurrency());
+
+	std::atomic<size_t> next{0};
+	auto worker=[&]()
+	{
+		for(size_t i=next++;i<m_Jobs.size();i=next++)
+		{
+			try
+			{
+				run(m_Jobs[i],m_Results[i]);
+			}
+			catch(const std::exception& e)
+			{
+				m_Results[i].error=e.what();
+			}
+		}
+	};
+
+	std::vector<std::future<void>> pool;
+	for(unsigned int t=1;t<threads && t<m_Jobs.size();t++)
+		pool.push_back(std::async(std::launch::async,worker));
+	worker();
+	for(auto& f:pool) f.get();
+
+	return m_Results;
+}
+
+void BatchRunner::WriteReport(const string& fn) const
+{
+	std::ofstream f(fn);
+	if(!f) throw std::runtime_error("Cannot write report '"+fn+"'");
+
+	size_t failed=0;
+	double load=0,partition=0;
+	f << "{\n  \"jobs\": [";
+	for(size_t i=0;i<m_Results.size();i++)
+	{
+		const Job& j=m_Jobs[i];
+		const Result& r=m_Results[i];
+		if(!r.ok) failed++;
+		load+=r.loadTime;
+		partition+=r.partitionTime;
+
+		f << (i?",":"") << "\n    {\"input\": " << quoted(j.input)
+			<< ", \"output\": " << quoted(j.output)
+			<< ", \"seed\": " << j.seed
+			<< ", \"ok\": " << (r.ok?"true":"false");
+		if(!r.ok) f << ", \"error\": " << quoted(r.error);
+		f << ", \"cells\": " << r.cells << ", \"nets\": " << r.nets
+			<< ", \"cut\": " << r.cut
+			<< ", \"left\": " << r.left << ", \"right\": " << r.right
+			<< ", \"converged\": " << (r.converged?"true":"false")
+			<< ", \"cached\": " << (r.cached?"true":"false")
+			<< ", \"load_s\": " << r.loadTime << ", \"partition_s\": " << r.partitionTime
+			<< ", \"memory\": " << r.memory << ", \"peak_memory\": " << r.peakMemory << "}";
+	}
+	f << "\n  ],\n  \"total\": {\"jobs\": " << m_Results.size() << ", \"failed\": " << failed
+		<< ", \"load_s\": " << load << ", \"partition_s\": " << partition;
+	if(m_Cache)
+	{
+		const auto s=m_Cache->GetStats();
+		f << ", \"cache\": {\"hits\": " << s.hits << ", \"misses\": " << s.misses
+			<< ", \"rejected\": " << s.rejected << ", \"stored\": " << s.stored << "}";
+	}
+	f << "}\n}\n";
+}
@@ -2,7 +2,7 @@
 
 using namespace Novorado::Partition;
 
-Bucket::Bucket()
+Bucket::Bucket():std::pmr::map<Weight,CellList>(&m_Pool)
 {
 	//ctor
 	m_Square=0;
@@ -14,7 +14,7 @@ Bucket::~Bucket()
 	//dtor
 }
 
-Bucket::Bucket(const Bucket& other)
+Bucket::Bucket(const Bucket& other):BucketPool(),std::pmr::map<Weight,CellList>(&m_Pool)
 {
 	#ifdef CHECK_LOGIC
 	//copy ctor
@@ -33,34 +33,54 @@ Bucket& Bucket::operator=(const Bucket& rhs)
 	return *this;
 }
 
-void Bucket::FillByGain(CellList& cl)
+void Bucket::FillByGain(CellList& cl,bool head)
 {
 	#ifdef CHECK_LOGIC
 	if(!empty()) throw std::logic_error("Unable to start moving cells into a non-empty bucket");
 	#endif // CHECK_LOGIC
 
-	m_Square += cl.GetSquare();
+	// Squares of the cells taken, fixed cells stay in the locker
+	m_Square=0;
 	m_SumGain=0;
-	for(auto cellIt=cl.begin();cellIt!=cl.end();cellIt++)
+	for(auto cellIt=cl.begin();cellIt!=cl.end();)
 	{
+		auto cur=cellIt++;
 		// We're updating bucket gain, thus fixed cells are not counted
 		// as fixed cells stay in locker
-		if(cellIt->IsFixed()) continue;
-		Weight g=cellIt->GetGain();
+		if(cur->IsFixed()) continue;
+		Weight g=cur->GetGain();
 		m_SumGain+=(g);
-		cellIt->MoveToLocker(false); // remove from locker. Failure to do so will result
+		m_Square+=cur->GetSquare();
+		cur->MoveToLocker(false); // remove from locker. Failure to do so will result
 			// in wrong updated gains later
 		CellList& bl=(*this)[g];
-		cl.TransferTo(cellIt--,bl);
+		cl.TransferTo(cur,bl,true,head);
 	}
 	cl.InvalidateGain();
 }
 
+void Bucket::Drain(CellList& locker)
+{
+	for(auto& gl:*this)
+	{
+		CellList& bl=gl.second;
+		while(!bl.empty())
+		{
+			bl.begin()->MoveToLocker();
+			bl.TransferTo(bl.begin(),locker,false);
+		}
+	}
+	clear();
+	m_Square=0;
+	m_SumGain=0;
+	locker.InvalidateGain();
+}
+
 #ifdef  ALGORITHM_VERBOSE
 void Bucket::dbg(long id)
 {
 	std::cout << "BUCKET #" << id << " SQ=" << m_Square  << " GAIN=" << GetGain() << std::endl;
-	for(std::map<Weight,CellList>::iterator i=begin();i!=end();i++){
+	for(auto i=begin();i!=end();i++){
 		Weight g=i->first;
 		CellList& bl=i->second;
 		std::cout << " Gain " << g << " - " << std::flush;
@@ -0,0 +1,197 @@
+#include "cache.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <sys/stat.h>
+
+using namespace Novorado::Partition;
+
+namespace
+{
+	const char Magic[8]={'K','L','F','M','R','S','L','T'};
+	constexpr uint32_t Version=2;
+
+	// 128 bits of key from two independent functions: FNV-1a over the bytes
+	// and a splitmix64 chain over the values
+	struct Hash
+	{
+		uint64_t h[2]{0xcbf29ce484222325ull,0x9e3779b97f4a7c15ull};
+
+		static uint64_t mix(uint64_t z)
+		{
+			z=(z^(z>>30))*0xbf58476d1ce4e5b9ull;
+			z=(z^(z>>27))*0x94d049bb133111ebull;
+			return z^(z>>31);
+		}
+
+		template<class T> void add(T v)
+		{
+			static_assert(sizeof(T)<=sizeof(uint64_t),"Values are hashed by 64 bits");
+			const auto* p=reinterpret_cast<const unsigned char*>(&v);
+			for(size_t i=0;i<sizeof(T);i++) h[0]=(h[0]^p[i])*0x100000001b3ull;
+
+			uint64_t x=0;
+			std::memcpy(&x,&v,sizeof(T));
+			h[1]=mix(h[1]+0x9e3779b97f4a7c15ull+x);
+		}
+
+		void add(const string& s)
+		{
+			add(static_cast<uint64_t>(s.size()));
+			for(char c:s) add(c);
+		}
+	};
+
+	template<class T> void put(std::ofstream& f,const T& v)
+	{
+		f.write(reinterpret_cast<const char*>(&v),sizeof(v));
+	}
+
+	template<class T> bool get(std::ifstream& f,T& v)
+	{
+		return bool(f.read(reinterpret_cast<char*>(&v),sizeof(v)));
+	}
+
+	uint64_t pinCount(const NetlistHypergraph& g)
+	{
+		uint64_t rv=0;
+		for(const Net& n:g.nets) rv+=n.m_CellIds.size();
+		return rv;
+	}
+}
+
+ResultCache::ResultCache(const string& dir):m_Dir(dir)
+{
+	::mkdir(dir.c_str(),0777);
+}
+
+string ResultCache::Key(const NetlistHypergraph& g,const string& params)
+{
+	Hash h;
+	h.add(static_cast<uint64_t>(g.m_AllCells->size()));
+	for(const Cell& c:*g.m_AllCells)
+	{
+		h.add(static_cast<int64_t>(c.GetSquare()));
+		h.add(static_cast<uint8_t>(c.IsFixed()?1+(c.GetPartition()==&g.p1):0));
+	}
+
+	// Nets are hashed one by one, then the hashes in sorted order
+	std::vector<std::pair<uint64_t,uint64_t>> nets;
+	nets.reserve(g.nets.size());
+	std::vector<Index> ids;
+	for(const Net& n:g.nets)
+	{
+		ids.assign(n.m_CellIds.begin(),n.m_CellIds.end());
+		std::sort(ids.begin(),ids.end());
+		Hash nh;
+		nh.add(static_cast<int64_t>(n.GetWeight()));
+		for(Index c:ids) nh.add(static_cast<uint64_t>(c));
+		nets.emplace_back(nh.h[0],nh.h[1]);
+	}
+	std::sort(nets.begin(),nets.end());
+	h.add(static_cast<uint64_t>(nets.size()));
+	for(auto& n:nets)
+	{
+		h.add(n.first);
+		h.add(n.second);
+	}
+
+	h.add(static_cast<uint64_t>(g.m_LargeNetThreshold));
+	h.add(params);
+
+	std::stringstream s;
+	s << std::hex << std::setfill('0') << std::setw(16) << h.h[0] << std::setw(16) << h.h[1];
+	return s.str();
+}
+
+bool ResultCache::Load(NetlistHypergraph& g,const string& key)
+{
+	std::ifstream f(path(key),std::ios::binary);
+	if(!f)
+	{
+		m_Misses++;
+		return false;
+	}
+
+	auto& cells=*g.m_AllCells;
+	char magic[sizeof(Magic)];
+	uint32_t version=0;
+	uint64_t count=0,nets=0,pins=0;
+	int64_t cut=0;
+	string bits;
+	// Sizes guard against a key collision
+	bool good=f.read(magic,sizeof(magic)) && !std::memcmp(magic,Magic,sizeof(Magic))
+		&& get(f,version) && version==Version && get(f,count) && count==cells.size()
+		&& get(f,nets) && nets==g.nets.size() && get(f,pins) && pins==pinCount(g) && get(f,cut);
+	if(good)
+	{
+		bits.resize((count+7)/8);
+		good=bool(f.read(&bits[0],bits.size()));
+	}
+
+	// Sides are checked before the hypergraph is touched
+	std::vector<uint8_t> sides(cells.size());
+	for(size_t c=0;good && c<cells.size();c++)
+	{
+		sides[c]=(bits[c/8]>>(c%8))&1;
+		if(cells[c].IsFixed() && sides[c]!=(cells[c].GetPartition()==&g.p1)) good=false;
+	}
+	if(good) good=g.CutWeight(sides)==cut;
+
+	if(!good)
+	{
+		m_Rejected++;
+		m_Misses++;
+		return false;
+	}
+
+	for(size_t c=0;c<cells.size();c++) cells[c].SetPartition(sides[c]?&g.p1:&g.p0);
+	g.SyncLockers();
+	m_Hits++;
+	return true;
+}
+
+void ResultCache::Store(const NetlistHypergraph& g,const string& key)
+{
+	const auto& cells=*g.m_AllCells;
+	string bits((cells.size()+7)/8,'\0');
+	for(size_t c=0;c<cells.size();c++)
+	{
+		if(cells[c].GetPartition()==&g.p1) bits[c/8]|=static_cast<char>(1<<(c%8));
+	}
+
+	// Renamed into place, concurrent readers never see a partial file
+	const string fn=path(key), tmp=fn+".tmp"+std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+	{
+		std::ofstream f(tmp,std::ios::binary|std::ios::trunc);
+		if(!f) throw std::runtime_error("Cannot write cache file '"+tmp+"'");
+		f.write(Magic,sizeof(Magic));
+		put(f,Version);
+		put(f,static_cast<uint64_t>(cells.size()));
+		put(f,static_cast<uint64_t>(g.nets.size()));
+		put(f,pinCount(g));
+		put(f,static_cast<int64_t>(g.CutWeight()));
+		f.write(bits.data(),bits.size());
+		if(!f.flush()) throw std::runtime_error("Cannot write cache file '"+tmp+"'");
+	}
+	if(std::rename(tmp.c_str(),fn.c_str()))
+	{
+		std::remove(tmp.c_str());
+		throw std::runtime_error("Cannot rename cache file to '"+fn+"'");
+	}
+	m_Stored++;
+}
+
+ResultCache::Stats ResultCache::GetStats() const
+{
+	Stats s;
+	s.hits=m_Hits;
+	s.misses=m_Misses;
+	s.rejected=m_Rejected;
+	s.stored=m_Stored;
+	return s;
+}
@@ -7,7 +7,13 @@ using namespace Novorado::Partition;
 Cell::Cell()
 {
 	//ctor
-	SetId(-1);
+	SetId(InvalidIndex);
+}
+
+Cell::Cell(std::pmr::memory_resource* arena):m_Pins(arena)
+{
+	//ctor
+	SetId(InvalidIndex);
 }
 
 Cell::~Cell()
@@ -15,23 +21,18 @@ Cell::~Cell()
 	//dtor
 }
 
+// Copies share the state slot of the original
 Cell::Cell(Cell& rhs):Bridge::Id(rhs)
 {
 	m_Pins=rhs.m_Pins;
-	SetGain(rhs.GetGain());
-	SetPartition(rhs.GetPartition());
-	SetSquare(rhs.GetSquare());
-	MoveToLocker(rhs.IsInLocker());
+	m_State=rhs.m_State;
 	SetFixed(rhs.IsFixed());
 }
 
 Cell::Cell(const Cell& rhs):Bridge::Id(rhs)
 {
 	m_Pins=rhs.m_Pins;
-	SetGain(rhs.GetGain());
-	//SetPartition(rhs.GetPartition());
-	SetSquare(rhs.GetSquare());
-	MoveToLocker(rhs.IsInLocker());
+	m_State=rhs.m_State;
 	SetFixed(rhs.IsFixed());
 }
 
@@ -39,10 +40,7 @@ Cell& Cell::operator=(Cell& rhs)
 {
 	Bridge::Id::operator=(rhs);
 	m_Pins=rhs.m_Pins;
-	SetGain(rhs.GetGain());
-	SetPartition(rhs.GetPartition());
-	SetSquare(rhs.GetSquare());
-	MoveToLocker(rhs.IsInLocker());
+	m_State=rhs.m_State;
 	SetFixed(rhs.IsFixed());
 
 	return *this;
@@ -57,16 +55,12 @@ void Cell::MoveToLocker(bool f)
 	}
 	#endif // CHECK_LOGIC
 
-	flags.inLocker=f;
-}
-
-Partition* Cell::GetPartition() {
-	return m_PartitionPtr;
+	m_State->lock[GetUnsignedId()]=f;
 }
 
 void Cell::SetPartition(Partition* p)
 {
-	m_PartitionPtr=p;
+	m_State->side[GetUnsignedId()]=m_State->SideOf(p);
 }
 
 void Cell::IncrementGain(Weight w)
@@ -74,8 +68,6 @@ void Cell::IncrementGain(Weight w)
 #ifdef  ALGORITHM_VERBOSE
 	std::cout << "cell " << (IsInLocker()?"L":"B") << " " << GetName() << " Cell::IncrementGain(" << w << ") " << GetGain() << " => " << (GetGain()+w) << std::endl;
 #endif
-	m_Gain+=w;
-	if(!IsInLocker()) GetPartition()->m_Bucket.IncrementGain(w);
-		else GetPartition()->m_Locker.IncrementSumGain(w);
+	m_State->IncrementGain(GetUnsignedId(),w);
 }
 
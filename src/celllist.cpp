@@ -1,5 +1,4 @@
 #include "celllist.h"
-#include <algorithm>
 #include <sstream>
 #include "partition.h"
 
@@ -14,7 +13,6 @@ void CellList::init(const std::vector<Cell*>& v)
 CellList::CellList()
 {
 	//ctor
-	flags.SquareComputed=false;
 	flags.GainComputed=false;
 	m_Square=0;
 	m_SumGain=0;
@@ -23,9 +21,10 @@ CellList::CellList()
 CellList::~CellList()
 {
 	//dtor
+	// Cells are not owned and may be gone already when the hypergraph is destroyed
 }
 
-Weight CellList::GetSumGain()
+Cost CellList::GetSumGain()
 {
 	if(flags.GainComputed) return m_SumGain;
 	flags.GainComputed=true;
@@ -36,93 +35,78 @@ Weight CellList::GetSumGain()
 
 CellList::Iterator CellList::find(Cell& cell)
 {
-	if(cell.GetUnsignedId()<cellId2cells.size() &&
-		cellId2cells[cell.GetUnsignedId()]!=-1)
-	{
-		return Iterator(this,cellId2cells[cell.GetUnsignedId()]);
-	}
+	if(cell.m_Hook.owner==this) return Iterator(&cell);
 
 	return end();
 }
 
-void CellList::removeCell(Cell& cell)
+void CellList::link(Cell* pos,Cell& cell)
+{
+	Cell::ListHook& h=cell.m_Hook;
+
+	h.owner=this;
+	h.next=pos;
+	h.prev=pos?pos->m_Hook.prev:m_Tail;
+
+	if(h.prev) h.prev->m_Hook.next=&cell;
+		else m_Head=&cell;
+
+	if(pos) pos->m_Hook.prev=&cell;
+		else m_Tail=&cell;
+
+	m_Size++;
+	m_Square+=cell.GetSquare();
+}
+
+void CellList::unlink(Cell& cell)
 {
+	Cell::ListHook& h=cell.m_Hook;
+
+	if(h.prev) h.prev->m_Hook.next=h.next;
+		else m_Head=h.next;
+
+	if(h.next) h.next->m_Hook.prev=h.prev;
+		else m_Tail=h.prev;
 
-	long idx=cellId2cells[cell.GetUnsignedId()];
+	h=Cell::ListHook();
+
+	m_Size--;
+	m_Square-=cell.GetSquare();
+}
+
+void CellList::removeCell(Cell& cell)
+{
 	#ifdef CHECK_LOGIC
-	if(cells[idx]!=&cell)
+	if(cell.m_Hook.owner!=this)
 	{
 		throw std::logic_error("data corruption");
 	}
 	#endif
-	cellId2cells[cell.GetUnsignedId()]=-1;
-	cells[idx]=NULL;
 
-	dirty=true;
+	unlink(cell);
 }
 
-void CellList::insertCell(Iterator pos,Cell& cell)
+void CellList::clear()
 {
-	// Enlarge cells vector if needed
-	if(static_cast<unsigned int>(pos.idx)>=cells.size())
-	{
-		// Should add 1 element
-		if(pos.idx!=cells.size()) dirty=true;
-		size_t cur=cells.size();
-		cells.resize(pos.idx+1);
-		for(;cur<cells.size();cur++) cells[cur]=NULL;
-	}
-
-	// Enlarge id vector if needed
-	if(cell.GetId()>=cellId2cells.size())
-	{
-		size_t cur=cellId2cells.size();
-		cellId2cells.resize(cell.GetId()+1);
-		for(;cur<cellId2cells.size();cur++) cellId2cells[cur]=-1;
-	}
+	while(m_Head) unlink(*m_Head);
+	InvalidateGain();
+}
 
+void CellList::insertCell(Iterator pos,Cell& cell)
+{
 	#ifdef CHECK_LOGIC
-	if(cells[pos.idx]!=NULL)
+	if(cell.m_Hook.owner!=nullptr)
 	{
 		throw std::logic_error("Cell already initialized");
 	}
-	#endif // CHECK_LOGIC
-
-	cells[pos.idx]=&cell;
 
-	#ifdef CHECK_LOGIC
-	if(cellId2cells[cell.GetId()]!=-1)
+	if(pos.m_Cell && pos.m_Cell->m_Hook.owner!=this)
 	{
 		throw std::logic_error("Data integrity violation");
 	}
 	#endif // CHECK_LOGIC
 
-	cellId2cells[cell.GetId()]=pos.idx;
-}
-
-void CellList::pack()
-{
-	#if 0 && defined(ALGORITHM_VERBOSE)
-	std::cout << "CellList::pack() initial size=" << cells.size() ;
-	#endif // ALGORITHM_VERBOSE
-
-	// remove all empty cells
-    cells.erase(
-    	std::remove_if(
-			cells.begin(),
-			cells.end(),
-			[](Cell* pt) { return pt==NULL; }
-			)
-    	);
-
-	Index i{0};
-	for(Cell* pt:cells) cellId2cells[pt->GetUnsignedId()]=i++;
-
-	dirty=false;
-
-	#if 0 && defined(ALGORITHM_VERBOSE)
-	std::cout << " size=" << cells.size() << std::endl;
-	#endif // ALGORITHM_VERBOSE
+	link(pos.m_Cell,cell);
 }
 
 void CellList::splice(Iterator posTo,CellList& from,Iterator posInFrom)
@@ -142,10 +126,10 @@ void CellList::splice(Iterator posTo,CellList& from,Iterator posInFrom)
 
 void CellList::splice(Iterator posTo,CellList& from)
 {
-	while(!from.empty()) splice(posTo++,from,from.begin());
+	while(!from.empty()) splice(posTo,from,from.begin());
 }
 
-void CellList::TransferTo(CellList::Iterator it, CellList& cl,bool UpdateGain)
+void CellList::TransferTo(CellList::Iterator it, CellList& cl,bool UpdateGain,bool head)
 {
 	Cell& cell=*it;
 
@@ -165,25 +149,17 @@ void CellList::TransferTo(CellList::Iterator it, CellList& cl,bool UpdateGain)
 		cl.IncrementSumGain(cell.GetGain());
 		}
 
-	m_Square=GetSquare()-cell.GetSquare();
-	cl.m_Square=cl.GetSquare()+cell.GetSquare();
-
-	cl.splice(cl.end(),*this,it);
-}
-
-Square CellList::GetSquare()
-{
-	if(flags.SquareComputed) return m_Square;
-	m_Square=0;
-	flags.SquareComputed=true;
-	for(auto i:cells) m_Square+=i->GetSquare();
-	return m_Square;
+	if(head)
+	{
+		// Head is taken once the cell is out, it may be the cell itself
+		removeCell(cell);
+		cl.insertCell(cl.begin(),cell);
+	}
+	else cl.splice(cl.end(),*this,it);
 }
 
 void CellList::TransferAllFrom(CellList& cl)
 {
-	m_Square=GetSquare()+cl.GetSquare();
-	cl.m_Square=0;
 	splice(end(),cl);
 }
 
@@ -202,7 +178,7 @@ void CellList::SetCellGain(Weight g)
  	for(auto& cell:*this) cell.SetGain(g);
 }
 
-Weight CellList::IncrementSumGain(Weight g)
+Cost CellList::IncrementSumGain(Weight g)
 {
 	#if 0 && defined(ALGORITHM_VERBOSE)
 	std::cout << "CellList::IncrementSumGain(" << g << ") " << GetSumGain() << " => " << (GetSumGain()+g) << std::endl;
@@ -0,0 +1,41 @@
+#include "cellstate.h"
+#include "partition.h"
+
+using namespace Novorado::Partition;
+
+void CellState::reserve(size_t n)
+{
+	gain.reserve(n);
+	side.reserve(n);
+	lock.reserve(n);
+	area.reserve(n);
+}
+
+size_t CellState::add()
+{
+	gain.push_back(0);
+	side.push_back(NoSide);
+	lock.push_back(false);
+	area.push_back(0);
+	return gain.size()-1;
+}
+
+uint8_t CellState::SideOf(const Partition* p) const
+{
+	if(p==parts[0]) return 0;
+	if(p==parts[1]) return 1;
+
+	#ifdef CHECK_LOGIC
+	if(p) throw std::logic_error("Partition does not belong to the hypergraph");
+	#endif // CHECK_LOGIC
+
+	return NoSide;
+}
+
+void CellState::IncrementGain(size_t i,Weight w)
+{
+	gain[i]+=w;
+	Partition* p=GetPartition(i);
+	if(!lock[i]) p->m_Bucket.IncrementGain(w);
+		else p->m_Locker.IncrementSumGain(w);
+}
@@ -0,0 +1,135 @@
+#include "checkpoint.h"
+#include "trace.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+using namespace Novorado::Partition;
+
+namespace
+{
+	const char Magic[8]={'K','L','F','M','C','K','P','T'};
+	constexpr uint32_t Version=1;
+
+	template<class T> void put(std::ofstream& f,const T& v)
+	{
+		f.write(reinterpret_cast<const char*>(&v),sizeof(v));
+	}
+
+	template<class T> void get(std::ifstream& f,T& v)
+	{
+		f.read(reinterpret_cast<char*>(&v),sizeof(v));
+	}
+}
+
+void Checkpoint::Capture(const NetlistHypergraph& g,uint32_t _pass)
+{
+	pass=_pass;
+	cut=g.CutWeight();
+	const CellList* lockers[2]={&g.p0.m_Locker,&g.p1.m_Locker};
+	for(int s=0;s<2;s++)
+	{
+		order[s].clear();
+		order[s].reserve(lockers[s]->size());
+		for(const Cell& c:*lockers[s]) order[s].push_back(c.GetUnsignedId());
+	}
+}
+
+void Checkpoint::Restore(NetlistHypergraph& g) const
+{
+	auto& cells=*g.m_AllCells;
+	if(order[0].size()+order[1].size()!=cells.size())
+	{
+		throw std::runtime_error("Checkpoint cell count does not match the netlist");
+	}
+
+	#ifdef CHECK_LOGIC
+	if(!g.p0.m_Bucket.empty() || !g.p1.m_Bucket.empty())
+	{
+		throw std::logic_error("Checkpoint restored while cells are in buckets");
+	}
+	#endif // CHECK_LOGIC
+
+	g.p0.m_Locker.clear();
+	g.p1.m_Locker.clear();
+	for(Cell& c:cells) c.MoveToLocker(false);
+	class Partition* sides[2]={&g.p0,&g.p1};
+	for(int s=0;s<2;s++)
+	{
+		for(Index c:order[s])
+		{
+			if(c>=cells.size() || cells[c].IsInLocker())
+			{
+				throw std::runtime_error("Checkpoint lists a cell twice or out of range");
+			}
+			cells[c].SetPartition(sides[s]);
+			sides[s]->m_Locker.insertCell(sides[s]->m_Locker.end(),cells[c]);
+			cells[c].MoveToLocker();
+		}
+	}
+
+	if(g.CutWeight()!=cut)
+	{
+		throw std::runtime_error("Checkpoint cut does not match the netlist");
+	}
+
+	g.FillBuckets();
+}
+
+void Checkpoint::Write(const string& fn) const
+{
+	KLFM_TRACE_SCOPE("Checkpoint::Write");
+	const string tmp=fn+".tmp";
+	{
+		std::ofstream f(tmp,std::ios::binary|std::ios::trunc);
+		if(!f) throw std::runtime_error("Cannot write checkpoint '"+tmp+"'");
+
+		f.write(Magic,sizeof(Magic));
+		put(f,Version);
+		put(f,static_cast<uint8_t>(sizeof(Index)));
+		put(f,static_cast<uint8_t>(sizeof(Weight)));
+		put(f,pass);
+		put(f,cut);
+		put(f,static_cast<uint64_t>(order[0].size()+order[1].size()));
+		put(f,static_cast<uint64_t>(order[0].size()));
+		for(const auto& o:order) f.write(reinterpret_cast<const char*>(o.data()),o.size()*sizeof(Index));
+
+		if(!f.flush()) throw std::runtime_error("Cannot write checkpoint '"+tmp+"'");
+	}
+	if(std::rename(tmp.c_str(),fn.c_str()))
+	{
+		throw std::runtime_error("Cannot rename checkpoint to '"+fn+"'");
+	}
+}
+
+void Checkpoint::Read(const string& fn)
+{
+	std::ifstream f(fn,std::ios::binary);
+	if(!f) throw std::runtime_error("Cannot open checkpoint '"+fn+"'");
+
+	char magic[sizeof(Magic)];
+	uint32_t version=0;
+	uint8_t indexSize=0,weightSize=0;
+	uint64_t cells=0,left=0;
+	f.read(magic,sizeof(magic));
+	get(f,version);
+	get(f,indexSize);
+	get(f,weightSize);
+	if(!f || std::memcmp(magic,Magic,sizeof(Magic)) || version!=Version
+		|| indexSize!=sizeof(Index) || weightSize!=sizeof(Weight))
+	{
+		throw std::runtime_error("'"+fn+"' is not a checkpoint of this build");
+	}
+
+	get(f,pass);
+	get(f,cut);
+	get(f,cells);
+	get(f,left);
+	if(!f || left>cells) throw std::runtime_error("Corrupt checkpoint '"+fn+"'");
+
+	order[0].resize(left);
+	order[1].resize(cells-left);
+	for(auto& o:order) f.read(reinterpret_cast<char*>(o.data()),o.size()*sizeof(Index));
+	if(!f) throw std::runtime_error("Truncated checkpoint '"+fn+"'");
+}
@@ -0,0 +1,231 @@
+#include "components.h"
+#include "trace.h"
+#include "pin.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <future>
+#include <numeric>
+#include <thread>
+
+using namespace Novorado::Partition;
+
+ComponentPartitioner::ComponentPartitioner(NetlistHypergraph& g):
+	ComponentPartitioner(g,Params())
+{
+}
+
+ComponentPartitioner::ComponentPartitioner(NetlistHypergraph& g,const Params& p):
+	m_Graph(g),m_Params(p)
+{
+	//ctor
+}
+
+void ComponentPartitioner::find()
+{
+	const size_t nc=m_Graph.m_AllCells->size();
+
+	// Union-find with path halving and union by size
+	std::vector<Index> parent(nc),size(nc,1);
+	std::iota(parent.begin(),parent.end(),0);
+	auto root=[&](Index c)
+	{
+		while(parent[c]!=c) c=parent[c]=parent[parent[c]];
+		return c;
+	};
+
+	for(const Net& net:m_Graph.nets)
+	{
+		if(net.m_CellIds.empty() || m_Graph.IsLargeNet(net)) continue;
+		Index a=root(net.m_CellIds.front());
+		for(Index c:net.m_CellIds)
+		{
+			Index b=root(c);
+			if(a==b) continue;
+			if(size[a]<size[b]) std::swap(a,b);
+			parent[b]=a;
+			size[a]+=size[b];
+		}
+	}
+
+	// Components are numbered in the order of their lowest cell id,
+	// members are in id order
+	std::vector<Index> number(nc,InvalidIndex);
+	m_Component.assign(nc,InvalidIndex);
+	m_Members.clear();
+	for(size_t i=0;i<nc;i++)
+	{
+		const Index r=root(static_cast<Index>(i));
+		if(number[r]==InvalidIndex)
+		{
+			number[r]=static_cast<Index>(m_Members.size());
+			m_Members.emplace_back();
+		}
+		m_Component[i]=number[r];
+		m_Members[number[r]].push_back(static_cast<Index>(i));
+	}
+
+	m_Nets.assign(m_Members.size(),std::vector<Index>());
+	for(size_t n=0;n<m_Graph.nets.size();n++)
+	{
+		const Net& net=m_Graph.nets[n];
+		if(net.m_CellIds.empty() || m_Graph.IsLargeNet(net)) continue;
+		m_Nets[m_Component[net.m_CellIds.front()]].push_back(static_cast<Index>(n));
+	}
+}
+
+std::vector<uint8_t> ComponentPartitioner::bisect(size_t comp) const
+{
+	KLFM_TRACE_SCOPE("ComponentPartitioner::bisect");
+	const std::vector<Index>& members=m_Members[comp];
+	const std::vector<Index>& nets=m_Nets[comp];
+
+	auto local=[&](Index c)
+	{
+		return static_cast<size_t>(std::lower_bound(members.begin(),members.end(),c)-members.begin());
+	};
+
+	KLFM sub;
+	sub.Reserve(members.size(),nets.size());
+
+	for(Index c:members)
+	{
+		Cell& cell=(*m_Graph.m_AllCells)[c];
+		class Partition* side=nullptr;
+		if(cell.IsFixed()) side=cell.GetPartition()==&m_Graph.p1?&sub.p1:&sub.p0;
+		sub.AddCell(cell.GetName(),cell.GetSquare(),side);
+	}
+
+	for(Index n:nets)
+	{
+		Net& net=m_Graph.nets[n];
+		Net& copy=sub.AddNet(net.GetName(),net.GetWeight());
+		copy.Reserve(net.Dim());
+		for(Pin* p:net.m_Pins)
+		{
+			sub.Connect((*sub.m_AllCells)[local(p->GetCell()->GetId())],copy,p->GetName(),p->GetCount());
+		}
+	}
+
+	// Refine is deterministic, components give the same result whichever
+	// thread runs them unless stopped
+	Progress progress;
+	progress.Follow(m_Params.progress);
+	sub.SetProgress(&progress);
+	sub.SetDeadline(m_Params.deadline);
+	sub.Refine<CutPolicies>();
+
+	std::vector<uint8_t> rv(members.size());
+	for(size_t i=0;i<members.size();i++) rv[i]=(*sub.m_AllCells)[i].GetPartition()==&sub.p1;
+	return rv;
+}
+
+bool ComponentPartitioner::stopped() const
+{
+	if(m_Params.progress && m_Params.progress->IsCancelled()) return true;
+	return m_Params.deadline!=KLFM::Clock::time_point::max() && KLFM::Clock::now()>=m_Params.deadline;
+}
+
+void ComponentPartitioner::Partition()
+{
+	KLFM_TRACE_SCOPE("ComponentPartitioner::Partition");
+	find();
+
+	const size_t nc=m_Members.size();
+	auto& cells=*m_Graph.m_AllCells;
+
+	// Fixed sides present in every component, bit 0 left and bit 1 right
+	std::vector<uint8_t> fixed(nc,0);
+	for(size_t i=0;i<cells.size();i++)
+	{
+		if(cells[i].IsFixed()) fixed[m_Component[i]]|=cells[i].GetPartition()==&m_Graph.p1?2:1;
+	}
+
+	std::vector<size_t> work;
+	for(size_t k=0;k<nc;k++)
+	{
+		if(m_Members[k].size()>=m_Params.minSize || fixed[k]==3) work.push_back(k);
+	}
+
+	// Sides within every component, whole components are all on side 0
+	// or on the side of their fixed cells
+	std::vector<std::vector<uint8_t>> sides(nc);
+	for(size_t k=0;k<nc;k++)
+	{
+		sides[k].assign(m_Members[k].size(),fixed[k]==2?1:0);
+		for(size_t i=0;i<m_Members[k].size();i++)
+		{
+			const Cell& c=cells[m_Members[k][i]];
+			if(c.IsFixed()) sides[k][i]=c.GetPartition()==&m_Graph.p1;
+		}
+	}
+
+	unsigned int threads=m_Params.threads;
+	if(!threads) threads=std::max(1u,std::thread::hardware_concurrency());
+
+	// Components not started when stopped stay whole
+	std::atomic<size_t> next{0},done{0};
+	auto worker=[&]()
+	{
+		for(size_t i=next++;i<work.size() && !stopped();i=next++)
+		{
+			sides[work[i]]=bisect(work[i]);
+			done++;
+		}
+	};
+
+	std::vector<std::future<void>> pool;
+	for(unsigned int t=1;t<threads && t<work.size();t++)
+		pool.push_back(std::async(std::launch::async,worker));
+	worker();
+	for(auto& f:pool) f.get();
+	m_Partitioned=done;
+
+	// Areas of both pieces of every component
+	std::vector<std::array<Square,2>> area(nc,{0,0});
+	for(size_t k=0;k<nc;k++)
+	{
+		for(size_t i=0;i<m_Members[k].size();i++)
+			area[k][sides[k][i]]+=cells[m_Members[k][i]].GetSquare();
+	}
+
+	// Components with fixed cells are oriented by them, the rest is packed
+	// largest piece first, the larger piece going to the lighter side
+	Square load[2]={0,0};
+	std::vector<uint8_t> flip(nc,0);
+	std::vector<size_t> loose;
+	for(size_t k=0;k<nc;k++)
+	{
+		if(fixed[k])
+		{
+			load[0]+=area[k][0];
+			load[1]+=area[k][1];
+		}
+		else loose.push_back(k);
+	}
+
+	std::stable_sort(loose.begin(),loose.end(),[&](size_t a,size_t b)
+		{
+			return std::max(area[a][0],area[a][1])>std::max(area[b][0],area[b][1]);
+		});
+
+	for(size_t k:loose)
+	{
+		const uint8_t lighter=load[0]<=load[1]?0:1;
+		const uint8_t larger=area[k][0]>=area[k][1]?0:1;
+		flip[k]=lighter!=larger;
+		load[lighter]+=area[k][larger];
+		load[1-lighter]+=area[k][1-larger];
+	}
+
+	for(size_t k=0;k<nc;k++)
+	{
+		for(size_t i=0;i<m_Members[k].size();i++)
+		{
+			const uint8_t s=sides[k][i]^flip[k];
+			cells[m_Members[k][i]].SetPartition(s?&m_Graph.p1:&m_Graph.p0);
+		}
+	}
+
+	m_Graph.SyncLockers();
+}
@@ -0,0 +1,339 @@
+#include "dynamic.h"
+#include "trace.h"
+#include "klfm18.h"
+#include "pin.h"
+#include <algorithm>
+#include <queue>
+
+using namespace Novorado::Partition;
+
+namespace
+{
+	// Bits of DynamicHypergraph::m_Mark
+	constexpr uint8_t InRegion=1, Locked=2, Seen=4;
+}
+
+DynamicHypergraph::DynamicHypergraph(NetlistHypergraph& g):
+	m_Graph(g)
+{
+	const size_t nc=g.m_AllCells->size(), nn=g.nets.size();
+
+	m_Count[0].assign(nn,0);
+	m_Count[1].assign(nn,0);
+	for(size_t n=0;n<nn;n++)
+	{
+		for(Index c:g.nets[n].m_CellIds) m_Count[side(c)][n]++;
+		m_Cut+=netCut(static_cast<Index>(n));
+	}
+
+	m_Gain.resize(nc);
+	for(size_t c=0;c<nc;c++)
+	{
+		m_Gain[c]=gain(static_cast<Index>(c));
+		m_Area[side(static_cast<Index>(c))]+=(*g.m_AllCells)[c].GetSquare();
+	}
+	m_IsTouched.assign(nc,false);
+	m_Mark.assign(nc,0);
+}
+
+Weight DynamicHypergraph::netCut(Index n) const
+{
+	return m_Count[0][n] && m_Count[1][n]?m_Graph.nets[n].GetWeight():0;
+}
+
+Weight DynamicHypergraph::gain(Index c) const
+{
+	// Nets of the cell, a net repeats once per pin
+	std::vector<Index> nets;
+	for(Pin& p:(*m_Graph.m_AllCells)[c].m_Pins) nets.push_back(p.GetNet()->GetUnsignedId());
+	std::sort(nets.begin(),nets.end());
+
+	const uint8_t s=side(c);
+	Weight g=0;
+	for(size_t i=0,j;i<nets.size();i=j)
+	{
+		for(j=i;j<nets.size() && nets[j]==nets[i];j++);
+		const Index n=nets[i], pins=static_cast<Index>(j-i);
+		// Net is cut before the move if the other side has pins, and after
+		// it if this side keeps some
+		const bool before=m_Count[1-s][n]>0, after=m_Count[s][n]>pins;
+		if(before && !after) g+=m_Graph.nets[n].GetWeight();
+		if(!before && after) g-=m_Graph.nets[n].GetWeight();
+	}
+	return g;
+}
+
+void DynamicHypergraph::contribute(Index n,Weight sign)
+{
+	const Net& net=m_Graph.nets[n];
+	const Weight w=sign*net.GetWeight();
+	m_Cut+=sign*netCut(n);
+
+	// Cell holding all pins of a side, InvalidIndex if there are several
+	Index only[2]={InvalidIndex,InvalidIndex};
+	bool many[2]={false,false};
+	for(Index c:net.m_CellIds)
+	{
+		const uint8_t s=side(c);
+		if(only[s]==InvalidIndex) only[s]=c;
+			else if(only[s]!=c) many[s]=true;
+	}
+
+	for(uint8_t s=0;s<2;s++)
+	{
+		if(!m_Count[s][n]) continue;
+		if(m_Count[1-s][n])
+		{
+			// Cut net, the only cell of a side uncuts it by leaving
+			if(!many[s]) m_Gain[only[s]]+=w;
+		}
+		else if(many[s])
+		{
+			// Uncut net, any cell leaving cuts it, once per cell
+			for(Index c:net.m_CellIds)
+			{
+				if(m_Mark[c]&Seen) continue;
+				m_Mark[c]|=Seen;
+				m_Gain[c]-=w;
+			}
+			for(Index c:net.m_CellIds) m_Mark[c]&=~Seen;
+		}
+	}
+}
+
+void DynamicHypergraph::touch(Index c)
+{
+	if(m_IsTouched[c]) return;
+	m_IsTouched[c]=true;
+	m_Touched.push_back(c);
+}
+
+Index DynamicHypergraph::AddCell(const string& name,Square sq)
+{
+	auto& cells=*m_Graph.m_AllCells;
+	if(cells.size()==cells.capacity())
+		m_Graph.Grow(std::max<size_t>(16,2*cells.size()),m_Graph.nets.capacity());
+
+	const uint8_t s=m_Area[0]<=m_Area[1]?0:1;
+	class Partition& p=s?m_Graph.p1:m_Graph.p0;
+
+	Cell& cell=m_Graph.AddCell(name,sq);
+	cell.SetPartition(&p);
+	p.m_Locker.insertCell(p.m_Locker.end(),cell);
+	cell.MoveToLocker();
+	m_Graph.instances.init(cells.data(),cells.size());
+
+	m_Area[s]+=sq;
+	m_Gain.push_back(0);
+	m_IsTouched.push_back(false);
+	m_Mark.push_back(0);
+	touch(cell.GetUnsignedId());
+	return cell.GetUnsignedId();
+}
+
+void DynamicHypergraph::RemoveCell(Index c)
+{
+	Cell& cell=(*m_Graph.m_AllCells)[c];
+
+	std::vector<Index> nets;
+	for(Pin& p:cell.m_Pins) nets.push_back(p.GetNet()->GetUnsignedId());
+	std::sort(nets.begin(),nets.end());
+	nets.erase(std::unique(nets.begin(),nets.end()),nets.end());
+	for(Index n:nets) Disconnect(c,n);
+
+	SetSquare(c,0);
+	cell.SetFixed(false);
+	if(side(c)) move(c);
+	cell.SetFixed();
+}
+
+void DynamicHypergraph::SetSquare(Index c,Square sq)
+{
+	Cell& cell=(*m_Graph.m_AllCells)[c];
+	m_Area[side(c)]+=sq-cell.GetSquare();
+
+	// Locker square is kept per link, the cell is relinked in place
+	CellList& l=(side(c)?m_Graph.p1:m_Graph.p0).m_Locker;
+	auto it=l.find(cell);
+	if(it!=l.end())
+	{
+		auto next=it;
+		++next;
+		l.removeCell(cell);
+		cell.SetSquare(sq);
+		l.insertCell(next,cell);
+	}
+	else cell.SetSquare(sq);
+
+	touch(c);
+}
+
+Index DynamicHypergraph::AddNet(const string& name,Weight w)
+{
+	if(m_Graph.nets.size()==m_Graph.nets.capacity())
+		m_Graph.Grow(m_Graph.m_AllCells->capacity(),std::max<size_t>(16,2*m_Graph.nets.size()));
+
+	Net& net=m_Graph.AddNet(name,w);
+	m_Count[0].push_back(0);
+	m_Count[1].push_back(0);
+	return net.GetUnsignedId();
+}
+
+void DynamicHypergraph::RemoveNet(Index n)
+{
+	std::vector<Index> cells(m_Graph.nets[n].m_CellIds.begin(),m_Graph.nets[n].m_CellIds.end());
+	std::sort(cells.begin(),cells.end());
+	cells.erase(std::unique(cells.begin(),cells.end()),cells.end());
+	for(Index c:cells) Disconnect(c,n);
+}
+
+void DynamicHypergraph::SetWeight(Index n,Weight w)
+{
+	detach(n);
+	m_Graph.nets[n].SetWeight(w);
+	attach(n);
+	for(Index c:m_Graph.nets[n].m_CellIds) touch(c);
+}
+
+void DynamicHypergraph::Connect(Index c,Index n,const string& pinName)
+{
+	detach(n);
+	m_Graph.Connect((*m_Graph.m_AllCells)[c],m_Graph.nets[n],pinName);
+	m_Count[side(c)][n]++;
+	attach(n);
+	touch(c);
+}
+
+void DynamicHypergraph::Disconnect(Index c,Index n)
+{
+	Cell& cell=(*m_Graph.m_AllCells)[c];
+	Net& net=m_Graph.nets[n];
+
+	detach(n);
+
+	m_Count[side(c)][n]-=static_cast<Index>(net.RemovePins(c));
+	cell.m_Pins.remove_if([&](Pin& p){ return p.GetNet()==&net; });
+
+	attach(n);
+	touch(c);
+}
+
+void DynamicHypergraph::move(Index c)
+{
+	Cell& cell=(*m_Graph.m_AllCells)[c];
+	const uint8_t s=side(c), t=1-s;
+	class Partition* from=s?&m_Graph.p1:&m_Graph.p0, * to=t?&m_Graph.p1:&m_Graph.p0;
+
+	std::vector<Index> nets;
+	for(Pin& p:cell.m_Pins) nets.push_back(p.GetNet()->GetUnsignedId());
+	std::sort(nets.begin(),nets.end());
+
+	for(size_t i=0;i<nets.size();i++) if(!i || nets[i]!=nets[i-1]) detach(nets[i]);
+	for(Index n:nets)
+	{
+		m_Count[s][n]--;
+		m_Count[t][n]++;
+	}
+
+	auto it=from->m_Locker.find(cell);
+
+	#ifdef CHECK_LOGIC
+	if(it==from->m_Locker.end())
+	{
+		throw std::logic_error(std::string("Cell ")+cell.GetName()+" is not in the locker of its side");
+	}
+	#endif // CHECK_LOGIC
+
+	from->m_Locker.TransferTo(it,to->m_Locker,false);
+	cell.SetPartition(to);
+	m_Area[s]-=cell.GetSquare();
+	m_Area[t]+=cell.GetSquare();
+
+	for(size_t i=0;i<nets.size();i++) if(!i || nets[i]!=nets[i-1]) attach(nets[i]);
+}
+
+Weight DynamicHypergraph::Refine(size_t radius)
+{
+	KLFM_TRACE_SCOPE("DynamicHypergraph::Refine");
+	auto& cells=*m_Graph.m_AllCells;
+
+	// Touched cells and the cells up to <radius> nets away
+	std::vector<Index>& region=m_Region;
+	for(Index c:m_Touched)
+	{
+		m_Mark[c]|=InRegion;
+		region.push_back(c);
+	}
+	for(size_t level=0,first=0;level<radius;level++)
+	{
+		const size_t last=region.size();
+		for(size_t i=first;i<last;i++)
+		{
+			for(Pin& p:cells[region[i]].m_Pins)
+			{
+				for(Index x:p.GetNet()->m_CellIds)
+				{
+					if(m_Mark[x]&InRegion) continue;
+					m_Mark[x]|=InRegion;
+					region.push_back(x);
+				}
+			}
+		}
+		first=last;
+	}
+
+	auto legal=[&](Index c)
+	{
+		const uint8_t s=side(c);
+		const Square a=cells[c].GetSquare();
+		const Square to[2]={s?m_Area[0]+a:m_Area[0]-a,s?m_Area[1]-a:m_Area[1]+a};
+		const Square lo=std::min(to[0],to[1]), hi=std::max(to[0],to[1]);
+		if(hi<=(1.0+SQUARE_TOLERANCE)*lo) return true;
+		// Out of tolerance, but not worse than before
+		const Square before=m_Area[0]>m_Area[1]?m_Area[0]-m_Area[1]:m_Area[1]-m_Area[0];
+		return hi-lo<=before;
+	};
+
+	// Max heap by gain, lower id first. An entry is stale once the gain of its
+	// cell changed, the cell got a newer entry then
+	using Entry=std::pair<Weight,Index>;
+	auto less=[](const Entry& a,const Entry& b){ return a.first<b.first || (a.first==b.first && a.second>b.second); };
+	std::priority_queue<Entry,std::vector<Entry>,decltype(less)> heap(less);
+	auto push=[&](Index c)
+	{
+		if(m_Gain[c]>0 && !(m_Mark[c]&Locked) && !cells[c].IsFixed()) heap.emplace(m_Gain[c],c);
+	};
+	for(Index c:region) push(c);
+
+	// Every move strictly decreases the cut, every cell moves once. Cells
+	// breaking the balance wait for the next move, it changes the areas
+	std::vector<Index> waiting;
+	while(!heap.empty())
+	{
+		const Entry top=heap.top();
+		heap.pop();
+		const Index c=top.second;
+		if(m_Mark[c]&Locked || m_Gain[c]!=top.first) continue;
+		if(!legal(c))
+		{
+			waiting.push_back(c);
+			continue;
+		}
+
+		move(c);
+		m_Mark[c]|=Locked;
+		for(Pin& p:cells[c].m_Pins)
+		{
+			for(Index x:p.GetNet()->m_CellIds) if(m_Mark[x]&InRegion) push(x);
+		}
+		for(Index x:waiting) push(x);
+		waiting.clear();
+	}
+
+	for(Index c:region) m_Mark[c]=0;
+	region.clear();
+	for(Index c:m_Touched) m_IsTouched[c]=false;
+	m_Touched.clear();
+
+	return m_Cut;
+}
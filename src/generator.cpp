@@ -0,0 +1,144 @@
+#include "generator.h"
+#include "trace.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+
+using namespace Novorado::Partition;
+
+PlantedGenerator::PlantedGenerator(const Params& p):
+	m_Params(p)
+{
+	if(p.cells<4) throw std::invalid_argument("Planted bisection needs 4 cells at least");
+	if(!(p.rent>0 && p.rent<=1)) throw std::invalid_argument("Rent exponent is out of (0,1]");
+	if(p.maxNetSize<2) throw std::invalid_argument("Nets need 2 pins at least");
+	if(p.netsPerCell<0 || p.fixed<0 || p.fixed>1 || p.maxSquare<1)
+		throw std::invalid_argument("Negative net count, fixed fraction or square");
+}
+
+PlantedGenerator::Planted PlantedGenerator::Write(const string& netFile,const string& partFile) const
+{
+	KLFM_TRACE_SCOPE("PlantedGenerator::Write");
+	const Params& p=m_Params;
+	std::mt19937_64 rng(p.seed);
+	auto uniform=[&](size_t n){ return std::uniform_int_distribution<size_t>(0,n-1)(rng); };
+	std::uniform_real_distribution<double> unit(0,1);
+
+	std::ofstream f(netFile);
+	if(!f) throw std::runtime_error("Cannot write netlist '"+netFile+"'");
+
+	Planted rv;
+	rv.cells=p.cells;
+
+	// Sides: a random half of the cells on the left, in the shuffled order
+	std::vector<Index> order(p.cells);
+	for(size_t c=0;c<p.cells;c++) order[c]=static_cast<Index>(c);
+	std::shuffle(order.begin(),order.end(),rng);
+	const size_t half[2]={p.cells/2,p.cells-p.cells/2};
+	const Index* sides[2]={order.data(),order.data()+half[0]};
+	std::vector<uint8_t> side(p.cells);
+	for(size_t i=0;i<p.cells;i++) side[order[i]]=i>=half[0];
+
+	std::uniform_int_distribution<Square> square(1,p.maxSquare);
+	for(size_t c=0;c<p.cells;c++)
+	{
+		const Square sq=square(rng);
+		(side[c]?rv.right:rv.left)+=sq;
+		f << 'c' << c << ' ' << sq << '\n';
+	}
+	for(size_t c=0;c<p.cells;c++)
+	{
+		if(unit(rng)>=p.fixed) continue;
+		f << (side[c]?"fixedright c":"fixedleft c") << c << '\n';
+		rv.fixed++;
+	}
+
+	std::vector<double> sizeWeights;
+	for(size_t k=2;k<=p.maxNetSize;k++) sizeWeights.push_back(std::pow(double(k),-p.exponent));
+	std::discrete_distribution<size_t> netSize(sizeWeights.begin(),sizeWeights.end());
+
+	// Pin names are numbered per cell
+	std::vector<uint32_t> pins(p.cells,0);
+	std::vector<Index> net;
+	auto write=[&]()
+	{
+		bool cut=false;
+		f << 'n' << rv.nets << " 1";
+		for(Index c:net)
+		{
+			f << " c" << c << " p" << pins[c]++;
+			cut=cut || side[c]!=side[net.front()];
+		}
+		f << '\n';
+		rv.nets++;
+		rv.pins+=net.size();
+		if(cut) rv.cut++;
+	};
+
+	// <k> distinct cells of side <s> from the window following <at>
+	auto local=[&](uint8_t s,size_t at,size_t k)
+	{
+		const size_t n=half[s];
+		k=std::min(k,n);
+		const size_t w=std::min(n,std::max(k,static_cast<size_t>(std::ceil(std::pow(double(k),1/p.rent)))));
+		net.push_back(sides[s][at%n]);
+		for(size_t added=1;added<k;)
+		{
+			const Index c=sides[s][(at+1+uniform(w-1))%n];
+			if(std::find(net.end()-static_cast<std::ptrdiff_t>(added),net.end(),c)!=net.end()) continue;
+			net.push_back(c);
+			added++;
+		}
+	};
+
+	const size_t anchored=static_cast<size_t>(p.netsPerCell);
+	for(uint8_t s=0;s<2;s++)
+	{
+		for(size_t at=0;at<half[s];at++)
+		{
+			const size_t cnt=anchored+(unit(rng)<p.netsPerCell-double(anchored));
+			for(size_t i=0;i<cnt;i++)
+			{
+				net.clear();
+				local(s,at,2+netSize(rng));
+				if(net.size()>1) write();
+			}
+		}
+	}
+
+	const size_t cutNets=p.cutNets?p.cutNets:
+		std::max<size_t>(1,static_cast<size_t>(std::pow(double(p.cells),p.rent)/4));
+	for(size_t i=0;i<cutNets;i++)
+	{
+		const size_t k=2+netSize(rng), left=1+uniform(k-1);
+		net.clear();
+		local(0,uniform(half[0]),left);
+		local(1,uniform(half[1]),k-left);
+		write();
+	}
+
+	// Large nets take cells at a random offset in every stride of the design
+	const size_t large=std::max<size_t>(2,std::min(p.cells,p.largeNetSize?p.largeNetSize:p.cells/10));
+	for(size_t i=0;i<p.largeNets;i++)
+	{
+		net.clear();
+		const size_t stride=p.cells/large;
+		for(size_t k=0;k<large;k++) net.push_back(static_cast<Index>(k*stride+uniform(stride)));
+		write();
+		rv.largeNets++;
+	}
+
+	f.close();
+	if(!f) throw std::runtime_error("Writing netlist '"+netFile+"' failed");
+
+	if(!partFile.empty())
+	{
+		std::ofstream part(partFile);
+		if(!part) throw std::runtime_error("Cannot write solution file '"+partFile+"'");
+		for(size_t c=0;c<p.cells;c++) part << 'c' << c << ' ' << int(side[c]) << '\n';
+	}
+
+	return rv;
+}
@@ -1,17 +1,60 @@
 #include "hypergraph.h"
 #include "pin.h"
+#include "trace.h"
+#include <algorithm>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
 #include <sstream>
 
 using namespace Novorado::Partition;
 
-NetlistHypergraph::NetlistHypergraph():bestSolution(p0,p1)
+NetlistHypergraph::NetlistHypergraph():nets(m_Nets),bestSolution(p0,p1)
 {
 	//ctop
+	setup();
+}
+
+NetlistHypergraph::NetlistHypergraph(std::shared_ptr<NetlistHypergraph> g):
+	nets(g->nets),bestSolution(p0,p1),m_Shared(g)
+{
+	setup();
+	m_LargeNetThreshold=g->m_LargeNetThreshold;
+
+	// Cells keep their ids, facades only: no names and no pins
+	const auto& from=*g->m_AllCells;
+	m_AllCells->reserve(from.size());
+	m_State.reserve(from.size());
+	for(const Cell& c:from)
+	{
+		m_AllCells->emplace_back(m_Arena.get());
+		Cell& cell=m_AllCells->back();
+		cell.SetId(m_State.add());
+		cell.Attach(&m_State);
+		cell.SetSquare(c.GetSquare());
+		cell.SetPartition(c.GetPartition()==&g->p1?&p1:&p0);
+		cell.SetFixed(c.IsFixed());
+	}
+	instances.init(m_AllCells->data(),m_AllCells->size());
+}
+
+void NetlistHypergraph::setup()
+{
 	p0.SetId(0);
 	p1.SetId(1);
-	m_AllCells = std::make_shared<std::vector<Cell>>();
+	m_State.parts[0]=&p0;
+	m_State.parts[1]=&p1;
+	// Arena and its counted upstream live and die together
+	struct CountedArena
+	{
+		CountingResource heap;
+		std::pmr::monotonic_buffer_resource arena{&heap};
+	};
+	auto counted=std::make_shared<CountedArena>();
+	m_Arena = std::shared_ptr<std::pmr::monotonic_buffer_resource>(counted,&counted->arena);
+	m_ArenaHeap = std::shared_ptr<const CountingResource>(counted,&counted->heap);
+	m_AllCells = std::shared_ptr<std::vector<Cell>>(new std::vector<Cell>,
+		[arena=m_Arena](std::vector<Cell>* v) { delete v; });
 }
 
 NetlistHypergraph::~NetlistHypergraph()
@@ -20,6 +63,221 @@ NetlistHypergraph::~NetlistHypergraph()
 	m_AllCells.reset();
 }
 
+void NetlistHypergraph::Reserve(size_t cellCnt,size_t netCnt)
+{
+	#ifdef CHECK_LOGIC
+	if(m_Shared) throw std::logic_error("The netlist of a view is read only");
+	#endif // CHECK_LOGIC
+	m_AllCells->reserve(cellCnt);
+	m_State.reserve(cellCnt);
+	nets.reserve(netCnt);
+}
+
+void NetlistHypergraph::Grow(size_t cellCnt,size_t netCnt)
+{
+	#ifdef CHECK_LOGIC
+	if(m_Shared) throw std::logic_error("The netlist of a view is read only");
+	if(!p0.m_Bucket.empty() || !p1.m_Bucket.empty())
+	{
+		throw std::logic_error("Storage can't grow while cells are in buckets");
+	}
+	#endif // CHECK_LOGIC
+
+	auto& cells=*m_AllCells;
+	cellCnt=std::max(cellCnt,cells.size());
+	netCnt=std::max(netCnt,nets.size());
+
+	// Pins of every net as cell id and pin position in the cell, taken
+	// while the pointers are still valid
+	std::vector<std::vector<std::pair<Index,size_t>>> netPins(nets.size());
+	for(Cell& c:cells)
+	{
+		size_t k=0;
+		for(Pin& p:c.m_Pins)
+		{
+			p.SetId(k+1);
+			k++;
+		}
+	}
+	for(size_t n=0;n<nets.size();n++)
+	{
+		netPins[n].reserve(nets[n].m_Pins.size());
+		for(Pin* p:nets[n].m_Pins) netPins[n].emplace_back(p->GetCell()->GetUnsignedId(),p->GetUnsignedId()-1);
+	}
+
+	p0.m_Locker.clear();
+	p1.m_Locker.clear();
+
+	std::vector<Cell> grownCells;
+	grownCells.reserve(cellCnt);
+	for(Cell& c:cells)
+	{
+		grownCells.emplace_back(m_Arena.get());
+		Cell& g=grownCells.back();
+		g.Bridge::Id::operator=(c);
+		g.Attach(&m_State);
+		g.SetFixed(c.IsFixed());
+		for(Pin& p:c.m_Pins)
+		{
+			g.m_Pins.emplace_back(p);
+			g.m_Pins.back().SetCell(&g);
+		}
+	}
+
+	std::vector<Net> grownNets;
+	grownNets.reserve(netCnt);
+	for(Net& n:nets)
+	{
+		grownNets.emplace_back(m_Arena.get());
+		Net& g=grownNets.back();
+		g.Bridge::Id::operator=(n);
+		g.SetWeight(n.GetWeight());
+	}
+
+	cells.swap(grownCells);
+	nets.swap(grownNets);
+	m_State.reserve(cellCnt);
+
+	// Pins of a cell by position, nets refilled in their original pin order
+	std::vector<std::vector<Pin*>> pinAt(cells.size());
+	for(Cell& c:cells) for(Pin& p:c.m_Pins) pinAt[c.GetUnsignedId()].push_back(&p);
+	for(size_t n=0;n<nets.size();n++)
+	{
+		nets[n].Reserve(netPins[n].size());
+		for(const auto& k:netPins[n])
+		{
+			Pin* p=pinAt[k.first][k.second];
+			p->SetNet(&nets[n]);
+			nets[n].AddPin(p);
+		}
+	}
+
+	instances.init(cells.data(),cells.size());
+	InitializeLockers();
+	bestSolution.Capture(cells,m_Cost);
+}
+
+Cell& NetlistHypergraph::AddCell(const string& name,Square sq,Partition* side)
+{
+	#ifdef CHECK_LOGIC
+	if(m_Shared) throw std::logic_error("The netlist of a view is read only");
+	if(m_AllCells->size()==m_AllCells->capacity())
+	{
+		throw std::logic_error("Cell storage is not reserved, pin pointers would dangle");
+	}
+	#endif // CHECK_LOGIC
+
+	m_AllCells->emplace_back(m_Arena.get());
+	Cell& cell=m_AllCells->back();
+	cell.SetId(m_State.add());
+	cell.Attach(&m_State);
+	cell.SetName(name);
+	cell.SetSquare(sq);
+	cell.SetPartition(side?side:&p0);
+	if(side) cell.SetFixed();
+	return cell;
+}
+
+Net& NetlistHypergraph::AddNet(const string& name,Weight w)
+{
+	#ifdef CHECK_LOGIC
+	if(m_Shared) throw std::logic_error("The netlist of a view is read only");
+	if(nets.size()==nets.capacity())
+	{
+		throw std::logic_error("Net storage is not reserved, pin pointers would dangle");
+	}
+	#endif // CHECK_LOGIC
+
+	nets.emplace_back(m_Arena.get());
+	Net& net=nets.back();
+	net.SetId(nets.size()-1);
+	net.SetName(name);
+	net.SetWeight(w);
+	return net;
+}
+
+Pin& NetlistHypergraph::Connect(Cell& cell,Net& net,const string& pinName,Index count)
+{
+	#ifdef CHECK_LOGIC
+	if(m_Shared) throw std::logic_error("The netlist of a view is read only");
+	#endif // CHECK_LOGIC
+	cell.m_Pins.emplace_back();
+	Pin& pin=cell.m_Pins.back();
+	pin.SetId(cell.m_Pins.size());
+	pin.SetCell(&cell);
+	pin.SetName(pinName);
+	pin.SetNet(&net);
+	pin.SetCount(count);
+	net.AddPin(&pin);
+	return pin;
+}
+
+Pin& NetlistHypergraph::Connect(Cell& cell,Net& net)
+{
+	#ifdef CHECK_LOGIC
+	if(m_Shared) throw std::logic_error("The netlist of a view is read only");
+	#endif // CHECK_LOGIC
+	cell.m_Pins.emplace_back();
+	Pin& pin=cell.m_Pins.back();
+	pin.SetId(cell.m_Pins.size());
+	pin.SetCell(&cell);
+	pin.SetNet(&net);
+	net.AddPin(&pin);
+	return pin;
+}
+
+void NetlistHypergraph::CheckLimits() const
+{
+	auto fits=[](std::int64_t v,auto limit)
+	{
+		return v<=static_cast<std::int64_t>(std::numeric_limits<decltype(limit)>::max());
+	};
+
+	if(m_AllCells->size()>=InvalidIndex || nets.size()>=InvalidIndex)
+	{
+		throw std::overflow_error("Too many cells or nets for Index, rebuild with WIDE=1");
+	}
+
+	std::int64_t area=0;
+	for(Cell& c:*m_AllCells)
+	{
+		if(__builtin_add_overflow(area,static_cast<std::int64_t>(c.GetSquare()),&area) ||
+			!fits(area,Square()))
+		{
+			throw std::overflow_error("Total cell square does not fit Square, rebuild with WIDE=1");
+		}
+	}
+
+	// A pin of a net of d pins adds at most w*(d+1) to the gain of its cell,
+	// times its count, the gains of all pins of the net add up to at most
+	// w*(d+d*d). Cell gains are kept in Weight, their sums in Cost
+	std::vector<std::int64_t> gain(m_AllCells->size(),0);
+	std::int64_t total=0;
+	for(const Net& net:nets)
+	{
+		if(IsLargeNet(net)) continue;
+		const std::int64_t w=std::abs(static_cast<std::int64_t>(net.GetWeight()));
+		const std::int64_t d=static_cast<std::int64_t>(net.Count());
+		std::int64_t pin,all;
+		if(__builtin_mul_overflow(w,d+1,&pin) || __builtin_mul_overflow(pin,d,&all) ||
+			__builtin_add_overflow(total,all,&total))
+		{
+			throw std::overflow_error("Pin-pair gains of net "+net.GetName()+" do not fit Cost");
+		}
+		for(size_t k=0;k<net.m_CellIds.size();k++)
+		{
+			const Index c=net.m_CellIds[k];
+			std::int64_t add;
+			if(__builtin_mul_overflow(pin,static_cast<std::int64_t>(net.Count(k)),&add) ||
+				__builtin_add_overflow(gain[c],add,&gain[c]) || !fits(gain[c],Weight()))
+			{
+				throw std::overflow_error("Gain of cell "+(*m_AllCells)[c].GetName()+
+					" does not fit Weight, rebuild with WIDE=1");
+			}
+		}
+	}
+}
+
 void NetlistHypergraph::InitializeLockers()
 {
 	// Buckets get fill from the lockers
@@ -32,43 +290,60 @@ void NetlistHypergraph::InitializeLockers()
 	}
 }
 
-void NetlistHypergraph::FillBuckets()
+void NetlistHypergraph::SyncLockers()
 {
-	Weight left=0,right=0;
-
-	for(Net& net:nets) {
-		// Set gain for all cells beloging to this partition, with other net cells in other partition
-		left=right=0;
-
-		#ifdef  ALGORITHM_VERBOSE
-		std::cout << "======== NET " << net.GetName() << std::endl;
-		#endif
-		// compute gains
-		for(Pin* p:net.m_Pins){
-            auto& cell = *p->GetCell();
+	KLFM_TRACE_SCOPE("NetlistHypergraph::SyncLockers");
+	p0.m_Locker.clear();
+	p1.m_Locker.clear();
+	InitializeLockers();
+}
 
-			if(cell.GetPartition()==&p0) left+=net.GetWeight();
-			else if(cell.GetPartition()==&p1) right+=net.GetWeight();
+template<class P> void NetlistHypergraph::CountSides()
+{
+	for(auto& v:m_SidePins) v.assign(nets.size(),0);
+	m_Cost=0;
+	m_CutWeight=0;
+
+	for(size_t n=0;n<nets.size();n++){
+		const Net& net=nets[n];
+		for(size_t k=0;k<net.m_CellIds.size();k++){
+			const uint8_t side=m_State.side[net.m_CellIds[k]];
 			#ifdef CHECK_LOGIC
-			else throw std::logic_error("cell does not belong to ANY partition");
+			if(side==CellState::NoSide) throw std::logic_error("cell does not belong to ANY partition");
 			#endif // CHECK_LOGIC
+			m_SidePins[side][n]+=net.Count(k);
 			}
+		if(m_SidePins[0][n] && m_SidePins[1][n]) m_CutWeight+=net.GetWeight();
+		if(!IsLargeNet(net))
+			m_Cost+=P::Objective::cost(m_SidePins[0][n],m_SidePins[1][n],P::Weights::weight(net));
+		}
+}
+
+template<class P> void NetlistHypergraph::FillBuckets()
+{
+	KLFM_TRACE_SCOPE("NetlistHypergraph::FillBuckets");
+	CountSides<P>();
+	std::fill(m_State.gain.begin(),m_State.gain.end(),0);
+
+	for(size_t n=0;n<nets.size();n++) {
+		const Net& net=nets[n];
+		if(IsLargeNet(net)) continue;
 
-		// set gains
-		for(Pin* p:net.m_Pins){
-			Cell& cell = *p->GetCell();
+		#ifdef  ALGORITHM_VERBOSE
+		std::cout << "======== NET " << net.GetName() << std::endl;
+		#endif
+		const Weight w=P::Weights::weight(net);
 
-			if(cell.GetPartition()==&p0){
-				// cell on the left
-				cell.SetGain(cell.GetGain()+right-left+net.GetWeight());
+		// Every pin adds to the gain of its cell, by the pins on its side and on the other one
+		for(size_t k=0;k<net.m_CellIds.size();k++){
+			const Index id=net.m_CellIds[k];
+			const uint8_t side=m_State.side[id];
 
-				} else if(cell.GetPartition()==&p1){
-					// cell on the right
-					cell.SetGain(cell.GetGain()+left-right+net.GetWeight());
-					}
+			m_State.gain[id]+=static_cast<Weight>(net.Count(k))*
+				P::Objective::gain(m_SidePins[side][n],m_SidePins[1-side][n],w);
 
 			#ifdef  ALGORITHM_VERBOSE
-			std::cout << "Cell " << cell.GetName() <<":" << p->GetName() << " gain " << cell.GetGain() << std::endl;
+			std::cout << "Cell " << (*m_AllCells)[id].GetName() <<":" << net.m_Pins[k]->GetName() << " gain " << m_State.gain[id] << std::endl;
 			#endif
 			}
 		}
@@ -80,7 +355,7 @@ void NetlistHypergraph::FillBuckets()
 
 // This function is called after changing partition in the cell
 /*
-Table of gains N=24 Weight=2, moving left to right
+Table of pin pair gains N=24 Weight=2, moving left to right
 * dMC - delta gain on the cell being moved
 L	R	dLR	Gl	Gr	dMC
 12	12	0	1W	1W	-
@@ -97,66 +372,90 @@ L	R	dLR	Gl	Gr	dMC
 1	23	-22	23W	-21W	2W
 0	24	-24	25W	-23W	2W
 */
-Weight NetlistHypergraph::UpdateGains(Cell& c)
+template<class P> void NetlistHypergraph::UpdateGains(Cell& c)
 {
-	Weight rv=0;
-
-	Partition* newP=c.GetPartition(), *oldP=NULL;
+	const Index cid=c.GetId();
+	const uint8_t to=m_State.side[cid];
 
-	if(newP==&p0) oldP=&p1;
-	else if(newP==&p1) oldP=&p0;
 	#ifdef CHECK_LOGIC
-	else throw std::logic_error("Wrong parition pointer");
+	if(to==CellState::NoSide) throw std::logic_error("Wrong parition pointer");
 	#endif // CHECK_LOGIC
 
-	std::map<Cell*,Weight> prevGain;
+	const uint8_t from=1-to;
+	auto& pins=pinsOf(cid);
 
-	c.SetGain(0);
+	auto& prevGain=m_Workspace.touched;
+	prevGain.clear();
+	m_Workspace.next();
 
 	// Find all connected nets
-	for(Pin& p:c.m_Pins){
+	for(Pin& p:pins){
+
+		const Net& net = *p.GetNet();
+		const Index n=static_cast<Index>(&net-nets.data());
+		const Index m=p.GetCount(), F=m_SidePins[from][n], T=m_SidePins[to][n];
+		m_SidePins[from][n]-=m;
+		m_SidePins[to][n]+=m;
+		if(!T) m_CutWeight+=net.GetWeight();
+		if(F==m) m_CutWeight-=net.GetWeight();
 
-		Net& net = *p.GetNet();
+		if(IsLargeNet(net)) continue;
 
 #ifdef  ALGORITHM_VERBOSE
 		std::cout << "UPDATE GAIN NET " << net.GetName() << std::endl;
 #endif
-		long newPcnt=0,oldPcnt=0;
-
-		// Adjust gain for all cells affected
-		// It'll work for the cell moved if you do the math, same dG altough different formula
-		for(Pin* p:net.m_Pins) {
-			Cell& cell=*p->GetCell();
-
-			if(cell==c) continue;
-
-			Weight dG=0;
-			if(cell.GetPartition()==newP) { newPcnt++; dG=-2*net.GetWeight(); }
-			else {
-					if(cell.GetPartition()==oldP) { oldPcnt++; dG=2*net.GetWeight(); }
-					#ifdef CHECK_LOGIC
-					else { throw std::logic_error("Wrong parition pointer in cell"); }
-					#endif // CHECK_LOGIC
-			}
+		const Weight w=P::Weights::weight(net);
+		m_Cost+=P::Objective::cost(F-m,T+m,w)-P::Objective::cost(F,T,w);
+
+		// Change of the gain of every other pin left on the <from> and on the <to> side
+		const Weight dF=P::Objective::gain(F-m,T+m,w)-P::Objective::gain(F,T,w);
+		const Weight dT=P::Objective::gain(T+m,F-m,w)-P::Objective::gain(T,F,w);
+		if(!dF && !dT) continue;
+
+		// Adjust gain for all cells affected, the moved one is recomputed below.
+		// A pin with a count changes by the sum of the pins it stands for
+		for(size_t k=0;k<net.m_CellIds.size();k++) {
+			const Index id=net.m_CellIds[k];
+			if(id==cid) continue;
+
+			const uint8_t side=m_State.side[id];
+			#ifdef CHECK_LOGIC
+			if(side==CellState::NoSide) throw std::logic_error("Wrong parition pointer in cell");
+			#endif // CHECK_LOGIC
+			const Weight dG=static_cast<Weight>(net.Count(k))*(side==to?dT:dF);
+			if(!dG) continue;
 
 			// Store previous gain when we hit the cell for the first time
-			if(!cell.IsInLocker() && prevGain.find(&cell)==prevGain.end())
+			if(!m_State.lock[id] && m_Workspace.mark(id))
 			{
-				prevGain[&cell]=cell.GetGain();
+				prevGain.emplace_back(id,m_State.gain[id]);
 			}
 
-			cell.IncrementGain(dG);
-			rv+=dG;
+#ifdef  ALGORITHM_VERBOSE
+			(*m_AllCells)[id].IncrementGain(dG);
+#else
+			m_State.IncrementGain(id,dG);
+#endif
 			}
+		}
 
-		c.IncrementGain((oldPcnt-newPcnt)*net.GetWeight());
+	// Gain of the moved cell from the final counts of its nets
+	Weight g=0;
+	for(Pin& p:pins){
+		const Net& net = *p.GetNet();
+		if(IsLargeNet(net)) continue;
+		const Index n=static_cast<Index>(&net-nets.data());
+		g+=static_cast<Weight>(p.GetCount())*
+			P::Objective::gain(m_SidePins[to][n],m_SidePins[from][n],P::Weights::weight(net));
 		}
+	c.SetGain(g);
 
-	// Move cells to new buckets accordingly to the updated gain
-	for(std::pair<Cell*,Weight> k:prevGain){
+	// Move cells to new buckets accordingly to the updated gain, in id order
+	std::sort(prevGain.begin(),prevGain.end());
+	for(const auto& k:prevGain){
 
-		Cell& cell=*k.first;
-		Weight& prevGain=k.second;
+		Cell& cell=(*m_AllCells)[k.first];
+		const Weight& prevGain=k.second;
 
 		#ifdef CHECK_LOGIC
 		if(cell.IsInLocker())
@@ -178,12 +477,59 @@ Weight NetlistHypergraph::UpdateGains(Cell& c)
 		}
 		#endif // CHECK_LOGIC
 
-		previousBucket.TransferTo(it,newBucket);
+		previousBucket.TransferTo(it,newBucket,true,P::Tie::head);
 
 		// If no more cells for that gain in bucket, remove the entire bucket
 		if(previousBucket.empty())  cell.GetPartition()->m_Bucket.erase(prevGain);
 		}
+}
+
+template void NetlistHypergraph::CountSides<DefaultPolicies>();
+template void NetlistHypergraph::CountSides<UnitPolicies>();
+template void NetlistHypergraph::CountSides<CutPolicies>();
+template void NetlistHypergraph::FillBuckets<DefaultPolicies>();
+template void NetlistHypergraph::FillBuckets<UnitPolicies>();
+template void NetlistHypergraph::FillBuckets<CutPolicies>();
+template void NetlistHypergraph::UpdateGains<DefaultPolicies>(Cell&);
+template void NetlistHypergraph::UpdateGains<UnitPolicies>(Cell&);
+template void NetlistHypergraph::UpdateGains<CutPolicies>(Cell&);
+
+void NetlistHypergraph::Workspace::reset(size_t cells)
+{
+	if(stamp.size()!=cells)
+	{
+		stamp.assign(cells,0);
+		epoch=0;
+	}
+	touched.reserve(cells);
+}
 
+void NetlistHypergraph::Workspace::next()
+{
+	if(++epoch) return;
+	// Stamps wrapped around
+	std::fill(stamp.begin(),stamp.end(),0);
+	epoch=1;
+}
+
+Weight NetlistHypergraph::CutWeight(const std::vector<uint8_t>& sides) const
+{
+	#ifdef CHECK_LOGIC
+	if(sides.size()!=m_AllCells->size()) throw std::logic_error("Sides are not given for every cell");
+	#endif // CHECK_LOGIC
+
+	Weight rv=0;
+	for(const Net& net:nets)
+	{
+		if(net.m_CellIds.empty()) continue;
+		const uint8_t s=sides[net.m_CellIds.front()];
+		for(Index c:net.m_CellIds)
+		{
+			if(sides[c]==s) continue;
+			rv+=net.GetWeight();
+			break;
+		}
+	}
 	return rv;
 }
 
@@ -198,8 +544,10 @@ NetlistHypergraph::CutStat NetlistHypergraph::GetStats(
     for(std::vector<Net>::iterator i=nets.begin(); i!=nets.end(); i++)
     {
         Net& net=*i;
+        const bool large=IsLargeNet(net);
+        if(large) rv.m_LargeNets++;
         Partition* p=NULL;
-        for(std::vector<Pin*>::iterator j=net.m_Pins.begin();
+        for(auto j=net.m_Pins.begin();
         	j!=net.m_Pins.end(); j++)
         {
             if(!p)
@@ -213,13 +561,96 @@ NetlistHypergraph::CutStat NetlistHypergraph::GetStats(
                 msg << net.GetName() << " ";
                 rv.m_NetCut++;
                 rv.m_totWeight+=net.GetWeight();
+                if(large)
+                {
+                    rv.m_LargeCut++;
+                    rv.m_LargeWeight+=net.GetWeight();
+                }
                 break;
             }
         }
     }
     msg << "=" << rv.m_NetCut << ", total weight is " << rv.m_totWeight;
+    if(m_LargeNetThreshold)
+    {
+        msg << "\nLarge nets over " << m_LargeNetThreshold << " pins ignored by gains "
+            << rv.m_LargeNets << ", cut " << rv.m_LargeCut << ", weight " << rv.m_LargeWeight;
+    }
+    if(m_PartitionTime>0) msg << "\nPartitioned in " << m_PartitionTime << " s";
+    const auto memory=GetMemoryStats();
+    msg << "\nMemory " << memory.Current() << " bytes, peak " << memory.Peak();
     std::cout << msg.str()  << std::endl;
     if(fWrite)
         o << msg.str()  << std::endl;
     return rv;
 }
+
+MemoryStats NetlistHypergraph::current() const
+{
+	MemoryStats m;
+	// A view counts its cell facades, the shared netlist is counted by its owner
+	m.topology.current=m_AllCells->capacity()*sizeof(Cell)+m_Nets.capacity()*sizeof(Net)+
+		m_ArenaHeap->InUse();
+	// Walked on demand, names may change after they are added
+	for(const Cell& c:*m_AllCells)
+	{
+		m.names.current+=HeapBytes(c.GetName());
+		for(const Pin& p:c.m_Pins) m.names.current+=HeapBytes(p.GetName());
+	}
+	for(const Net& n:m_Nets) m.names.current+=HeapBytes(n.GetName());
+	m.state.current=m_State.Bytes()+
+		m_Workspace.touched.capacity()*sizeof(m_Workspace.touched[0])+
+		m_Workspace.stamp.capacity()*sizeof(uint32_t)+
+		(m_SidePins[0].capacity()+m_SidePins[1].capacity())*sizeof(Index);
+	m.buckets.current=p0.m_Bucket.HeapBytes()+p1.m_Bucket.HeapBytes();
+	m.solutions.current=bestSolution.Bytes();
+	return m;
+}
+
+MemoryStats NetlistHypergraph::GetMemoryStats()
+{
+	MemoryStats m=current();
+	auto peak=[](MemoryStats::Bytes& b,MemoryStats::Bytes& seen,size_t exact=0)
+	{
+		seen.peak=std::max({seen.peak,b.current,exact});
+		b.peak=seen.peak;
+	};
+	peak(m.topology,m_Memory.topology);
+	peak(m.names,m_Memory.names);
+	peak(m.state,m_Memory.state);
+	peak(m.buckets,m_Memory.buckets,p0.m_Bucket.PeakHeapBytes()+p1.m_Bucket.PeakHeapBytes());
+	peak(m.solutions,m_Memory.solutions);
+	return m;
+}
+
+MemoryStats NetlistHypergraph::EstimateRun() const
+{
+	MemoryStats m=current();
+	const size_t cells=m_AllCells->size();
+
+	// Gain of a cell is within the weighted pins of its nets, FillBuckets
+	std::vector<std::uint64_t> bound(cells,0);
+	for(const Net& net:nets)
+	{
+		if(IsLargeNet(net)) continue;
+		const std::uint64_t w=static_cast<std::uint64_t>(std::abs(static_cast<std::int64_t>(net.GetWeight())))*
+			net.Count();
+		for(Index id:net.m_CellIds) bound[id]+=w;
+	}
+	const std::uint64_t gains=2*(cells?*std::max_element(bound.begin(),bound.end()):0)+1;
+
+	// A map node per distinct gain on each side, the pool keeps them
+	using Node=std::pmr::map<Weight,CellList>::value_type;
+	const size_t nodes=static_cast<size_t>(std::min<std::uint64_t>(cells,gains));
+	const size_t buckets=2*nodes*(sizeof(Node)+4*sizeof(void*));
+
+	const size_t state=m_State.Bytes()+cells*(sizeof(uint32_t)+sizeof(m_Workspace.touched[0]))+
+		2*nets.size()*sizeof(Index);
+
+	m.topology.peak=m.topology.current;
+	m.names.peak=m.names.current;
+	m.state.peak=std::max(m.state.current,state);
+	m.buckets.peak=std::max(m.buckets.current,buckets);
+	m.solutions.peak=std::max(m.solutions.current,cells*sizeof(Solution::CellRecord));
+	return m;
+}
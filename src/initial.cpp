@@ -0,0 +1,291 @@
+#include "initial.h"
+#include "trace.h"
+#include "klfm18.h"
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <queue>
+#include <set>
+#include <thread>
+#include <tuple>
+
+using namespace Novorado::Partition;
+
+InitialPartitioner::InitialPartitioner(NetlistHypergraph& g):
+	m_Graph(g)
+{
+	const size_t nc=g.m_AllCells->size(), nn=g.nets.size();
+
+	std::vector<Index> seen(nc,InvalidIndex),degree(nc,0);
+	m_NetStart.assign(1,0);
+	for(size_t n=0;n<nn;n++)
+	{
+		if(!g.IsLargeNet(g.nets[n]))
+		{
+			for(Index c:g.nets[n].m_CellIds)
+			{
+				if(seen[c]==n) continue;
+				seen[c]=static_cast<Index>(n);
+				m_NetCells.push_back(c);
+				degree[c]++;
+			}
+		}
+		m_NetStart.push_back(static_cast<Index>(m_NetCells.size()));
+	}
+
+	m_CellStart.assign(nc+1,0);
+	for(size_t c=0;c<nc;c++) m_CellStart[c+1]=m_CellStart[c]+degree[c];
+	m_CellNets.resize(m_CellStart[nc]);
+	std::vector<Index> fill(m_CellStart.begin(),m_CellStart.end()-1);
+	for(size_t n=0;n<nn;n++)
+		for(Index k=m_NetStart[n];k<m_NetStart[n+1];k++)
+			m_CellNets[fill[m_NetCells[k]]++]=static_cast<Index>(n);
+
+	m_Area.resize(nc);
+	m_Fixed.resize(nc);
+	for(size_t c=0;c<nc;c++)
+	{
+		const Cell& cell=(*g.m_AllCells)[c];
+		m_Area[c]=cell.GetSquare();
+		m_Total+=m_Area[c];
+		m_Fixed[c]=cell.IsFixed()?(cell.GetPartition()==&g.p1?2:1):0;
+		if(!m_Fixed[c]) m_Largest=std::max(m_Largest,m_Area[c]);
+	}
+}
+
+std::vector<Index> InitialPartitioner::order(Rng& rng) const
+{
+	std::vector<Index> rv;
+	for(size_t c=0;c<m_Fixed.size();c++) if(!m_Fixed[c]) rv.push_back(static_cast<Index>(c));
+	std::shuffle(rv.begin(),rv.end(),rng);
+	return rv;
+}
+
+void InitialPartitioner::shuffle(Result& r,Rng& rng) const
+{
+	Square area[2]={0,0};
+	for(size_t c=0;c<m_Fixed.size();c++) if(m_Fixed[c]) area[r.sides[c]]+=m_Area[c];
+
+	for(Index c:order(rng))
+	{
+		const uint8_t s=area[0]<=area[1]?0:1;
+		r.sides[c]=s;
+		area[s]+=m_Area[c];
+	}
+}
+
+void InitialPartitioner::grow(Result& r,Rng& rng) const
+{
+	const std::vector<Index> seeds=order(rng);
+	const Square target=m_Total/2;
+
+	// Side 1 grows from cells fixed there, restarting from a random
+	// cell whenever the region is closed
+	std::vector<bool> visited(m_Fixed.size(),false);
+	std::queue<Index> q;
+	Square grown=0;
+	for(size_t c=0;c<m_Fixed.size();c++)
+	{
+		if(m_Fixed[c]==2)
+		{
+			visited[c]=true;
+			q.push(static_cast<Index>(c));
+			grown+=m_Area[c];
+		}
+		if(m_Fixed[c]==1) visited[c]=true;
+	}
+
+	size_t next=0;
+	while(grown<target)
+	{
+		if(q.empty())
+		{
+			while(next<seeds.size() && visited[seeds[next]]) next++;
+			if(next==seeds.size()) break;
+			visited[seeds[next]]=true;
+			q.push(seeds[next]);
+		}
+
+		const Index c=q.front();
+		q.pop();
+		if(!m_Fixed[c])
+		{
+			r.sides[c]=1;
+			grown+=m_Area[c];
+		}
+
+		for(Index k=m_CellStart[c];k<m_CellStart[c+1];k++)
+		{
+			const Index n=m_CellNets[k];
+			for(Index j=m_NetStart[n];j<m_NetStart[n+1];j++)
+			{
+				const Index x=m_NetCells[j];
+				if(visited[x]) continue;
+				visited[x]=true;
+				q.push(x);
+			}
+		}
+	}
+}
+
+void InitialPartitioner::greedy(Result& r,Rng& rng) const
+{
+	const std::vector<Index> seeds=order(rng);
+	const Square target=m_Total/2;
+
+	// Ties go to the earlier cell of the random order
+	std::vector<Index> rank(m_Fixed.size(),0);
+	for(size_t i=0;i<seeds.size();i++) rank[seeds[i]]=static_cast<Index>(seeds.size()-i);
+
+	// Cells of every net on the growing side 1
+	std::vector<Index> grownCells(m_NetStart.size()-1,0);
+	Square grown=0;
+
+	// Cut weight decrease of moving <c> to side 1
+	auto gain=[&](Index c)
+	{
+		Weight g=0;
+		for(Index k=m_CellStart[c];k<m_CellStart[c+1];k++)
+		{
+			const Index n=m_CellNets[k];
+			const Weight w=m_Graph.nets[n].GetWeight();
+			if(grownCells[n]+1==m_NetStart[n+1]-m_NetStart[n]) g+=w;
+			if(!grownCells[n]) g-=w;
+		}
+		return g;
+	};
+
+	// Ordered like the buckets, the same entry is kept once
+	using Entry = std::tuple<Weight,Index,Index>; // gain, rank, cell
+	std::set<Entry> q;
+
+	auto add=[&](Index c)
+	{
+		r.sides[c]=1;
+		grown+=m_Area[c];
+		for(Index k=m_CellStart[c];k<m_CellStart[c+1];k++)
+		{
+			const Index n=m_CellNets[k];
+			// Gains on the net change when it gets its first grown cell and
+			// when a single cell is left out, once per net each
+			const Index size=m_NetStart[n+1]-m_NetStart[n];
+			if(++grownCells[n]!=1 && grownCells[n]+1!=size) continue;
+			for(Index j=m_NetStart[n];j<m_NetStart[n+1];j++)
+			{
+				const Index x=m_NetCells[j];
+				if(!m_Fixed[x] && !r.sides[x]) q.emplace(gain(x),rank[x],x);
+			}
+		}
+	};
+
+	for(size_t c=0;c<m_Fixed.size();c++) if(m_Fixed[c]==2) add(static_cast<Index>(c));
+
+	size_t next=0;
+	while(grown<target)
+	{
+		if(q.empty())
+		{
+			while(next<seeds.size() && r.sides[seeds[next]]) next++;
+			if(next==seeds.size()) break;
+			add(seeds[next]);
+			continue;
+		}
+
+		// Cells are pushed again on every gain change, stale entries are skipped
+		const auto [g,k,c]=*q.rbegin();
+		q.erase(std::prev(q.end()));
+		if(r.sides[c] || g!=gain(c)) continue;
+		add(c);
+	}
+}
+
+void InitialPartitioner::evaluate(Result& r) const
+{
+	r.cut=0;
+	for(size_t n=0;n+1<m_NetStart.size();n++)
+	{
+		bool s[2]={false,false};
+		for(Index j=m_NetStart[n];j<m_NetStart[n+1];j++) s[r.sides[m_NetCells[j]]]=true;
+		if(s[0] && s[1]) r.cut+=m_Graph.nets[n].GetWeight();
+	}
+
+	Square area[2]={0,0};
+	for(size_t c=0;c<r.sides.size();c++) area[r.sides[c]]+=m_Area[c];
+	// Within tolerance, or one cell off when granularity does not allow it
+	const Square lo=std::min(area[0],area[1]), hi=std::max(area[0],area[1]);
+	r.balanced=lo && (hi<=(1.0+SQUARE_TOLERANCE)*lo || hi-lo<=m_Largest);
+}
+
+InitialPartitioner::Result InitialPartitioner::Run(Method m,uint32_t seed) const
+{
+	KLFM_TRACE_SCOPE("InitialPartitioner::Run");
+	Rng rng(seed);
+	Result r;
+	r.method=m;
+	r.sides.resize(m_Fixed.size());
+	for(size_t c=0;c<m_Fixed.size();c++) r.sides[c]=m_Fixed[c]==2?1:0;
+
+	switch(m)
+	{
+		case Method::Shuffle: shuffle(r,rng); break;
+		case Method::Grow: grow(r,rng); break;
+		case Method::GreedyGain: greedy(r,rng); break;
+	}
+
+	evaluate(r);
+	return r;
+}
+
+void InitialPartitioner::write(const Result& r)
+{
+	auto& cells=*m_Graph.m_AllCells;
+	for(size_t c=0;c<cells.size();c++) cells[c].SetPartition(r.sides[c]?&m_Graph.p1:&m_Graph.p0);
+	m_Graph.SyncLockers();
+}
+
+InitialPartitioner::Result InitialPartitioner::Apply(Method m,uint32_t seed)
+{
+	Result r=Run(m,seed);
+	write(r);
+	return r;
+}
+
+InitialPartitioner::Result InitialPartitioner::Apply(const Params& p)
+{
+	const size_t jobs=p.methods.size()*p.tries;
+
+	#ifdef CHECK_LOGIC
+	if(!jobs) throw std::logic_error("Empty initial partitioner portfolio");
+	#endif // CHECK_LOGIC
+
+	std::vector<Result> results(jobs);
+
+	unsigned int threads=p.threads;
+	if(!threads) threads=std::max(1u,std::thread::hardware_concurrency());
+
+	std::atomic<size_t> next{0};
+	auto worker=[&]()
+	{
+		for(size_t i=next++;i<jobs;i=next++)
+		{
+			results[i]=Run(p.methods[i/p.tries],p.seed+static_cast<uint32_t>(i%p.tries));
+		}
+	};
+
+	std::vector<std::future<void>> pool;
+	for(unsigned int t=1;t<threads && t<jobs;t++)
+		pool.push_back(std::async(std::launch::async,worker));
+	worker();
+	for(auto& f:pool) f.get();
+
+	// Balanced first, then by cut, the earlier job wins a tie
+	size_t best=0;
+	for(size_t i=1;i<jobs;i++)
+	{
+		const Result& a=results[i], & b=results[best];
+		if(a.balanced!=b.balanced ? a.balanced : a.cut<b.cut) best=i;
+	}
+
+	write(results[best]);
+	return results[best];
+}
@@ -1,5 +1,6 @@
 #include "iteration.h"
 #include "klfm18.h"
+#include "trace.h"
 
 using namespace Novorado::Partition;
 
@@ -30,9 +31,10 @@ void RandomDistribution::run()
 {
 	const long HRM = RAND_MAX / 2;
 	// Move all non-fixed elements to first partition p0
-	for(auto i=p1.m_Locker.begin();i!=p1.m_Locker.end();i++)
+	for(auto i=p1.m_Locker.begin();i!=p1.m_Locker.end();)
 	{
-        if(!i->IsFixed()) p0.m_Locker.splice(p0.m_Locker.end(),p1.m_Locker,i--);
+		auto cur=i++;
+        if(!cur->IsFixed()) p0.m_Locker.splice(p0.m_Locker.end(),p1.m_Locker,cur);
 	}
 
 	for(auto& cell:p0.m_Locker) cell.SetPartition(&p0);
@@ -40,40 +42,55 @@ void RandomDistribution::run()
 	while(p0.m_Locker.GetSquare()>p1.m_Locker.GetSquare())
 	{
 		for(auto i=p0.m_Locker.begin();
-			i!=p0.m_Locker.end() && p0.m_Locker.GetSquare()>p1.m_Locker.GetSquare();
-			i++)
+			i!=p0.m_Locker.end() && p0.m_Locker.GetSquare()>p1.m_Locker.GetSquare();)
 		{
-			if(!i->IsFixed() && std::rand()>HRM)
+			auto cur=i++;
+			if(!cur->IsFixed() && std::rand()>HRM)
 			{
-				i->SetPartition(&p1);
-				p0.m_Locker.TransferTo(i--,p1.m_Locker);
+				cur->SetPartition(&p1);
+				p0.m_Locker.TransferTo(cur,p1.m_Locker);
 		   }
 		}
 	}
 }
 
-Iteration::Iteration(NetlistHypergraph* _graph):CellMove(_graph->p0,_graph->p1)
+template<class P> Iteration<P>::Iteration(NetlistHypergraph* _graph,Clock::time_point deadline,
+	Progress* progress,MoveJournal* journal):
+	CellMove(_graph->p0,_graph->p1),m_Deadline(deadline),m_Progress(progress),m_Journal(journal)
 {
 	m_Improvement=-1;
 
 	//ctor
 	graph=_graph;
+	graph->m_Workspace.reset(graph->m_AllCells->size());
+	m_Balance.init(graph->m_State);
 }
 
-Iteration::~Iteration()
+template<class P> Iteration<P>::~Iteration()
 {
 	//dtor
 }
 
+template<class P> bool Iteration<P>::movable(int from)
+{
+	Partition& f=from?p1:p0, & t=from?p0:p1;
+	if(f.m_Bucket.empty()) return false;
+	const Cell& cell=*f.m_Bucket.rbegin()->second.begin();
+	return m_Balance.legal(t.GetSquare(),cell.GetSquare());
+}
+
 //
-// SUM OF CELL GAINS IN LEFT AND RIGHT LOCKER == NUMBER OF CUTTING NETS
-// We want to minimize locker0.gain+locker1.gain
+// SUM OF CELL GAINS IN LEFT AND RIGHT LOCKER == PIN PAIR COST (DefaultPolicies)
+// We want to minimize the cost of the objective, graph->m_Cost
 //
-void Iteration::run()
+template<class P> void Iteration<P>::run()
 {
-	// Gains are incrementally updated
-	p0.m_Bucket.FillByGain(p0.m_Locker);
-	p1.m_Bucket.FillByGain(p1.m_Locker);
+	KLFM_TRACE_SCOPE("Iteration::run");
+	// Gains are incrementally updated, the counts are of the sides restored
+	// from the best solution
+	graph->template CountSides<P>();
+	p0.m_Bucket.FillByGain(p0.m_Locker,P::Tie::head);
+	p1.m_Bucket.FillByGain(p1.m_Locker,P::Tie::head);
 
 #ifdef  ALGORITHM_VERBOSE
 	std::cout << "*** STARTING ITERATIONS ****" << std::endl;
@@ -85,7 +102,8 @@ void Iteration::run()
 #endif
 
 	// Only save solution after setting an initial gain
-	graph->bestSolution=Solution(p0,p1,*graph->m_AllCells);
+	graph->bestSolution.Capture(*graph->m_AllCells,graph->m_Cost);
+	if(m_Progress) m_Progress->Best(graph->bestSolution.Cut(),p0.GetSquare(),p1.GetSquare());
 
 	m_Improvement=0;
 #ifdef  ALGORITHM_VERBOSE
@@ -94,55 +112,44 @@ void Iteration::run()
 #ifdef  PRINT_PROGRESS
 	long Ll=p0.m_Locker.size(),Lr=p1.m_Locker.size();
 #endif //PRINT_PROGRESS
+	const bool timed=m_Deadline!=Clock::time_point::max();
+	size_t moves=0;
 
 	while(!p0.m_Bucket.empty() || !p1.m_Bucket.empty()){
 
+		// Clock is read once per DEADLINE_CHECK_MOVES moves
+		if(timed && !(moves++ & (DEADLINE_CHECK_MOVES-1)) && Clock::now()>=m_Deadline)
+		{
+			m_Expired=true;
+			break;
+		}
+
+		if(m_Progress && m_Progress->IsCancelled())
+		{
+			m_Cancelled=true;
+			break;
+		}
+
 #ifdef  ALGORITHM_VERBOSE
 		std::cout << "STEP #" << ++cnt << std::endl;
 #endif
 
-		if(p0.m_Bucket.empty())
-		{
-			// Left side is empty
-			if(!p1.m_Bucket.empty()) moveLeft();
-		}
+		// Side to move from: by balance, else by gain
+		int from;
+		if(p0.m_Bucket.empty()) from=1;
+		else if(p1.m_Bucket.empty()) from=0;
 		else
 		{
-			if(p1.m_Bucket.empty())
-			{
-				// Right side is empty
-				if(!p0.m_Bucket.empty()) moveRight();
-			}
-			else
-			{
-				// Both left and right side are not empty
-				if(p0.GetSquare()>(1.0+SQUARE_TOLERANCE)*p1.GetSquare())
-				{
-					// Due to square balance, we can only move right
-					moveRight();
-
-				}
-				else if(p1.GetSquare()>(1.0+SQUARE_TOLERANCE)*p0.GetSquare())
-				{
-					moveLeft();
-				}
-				else
-				{
-					struct {
-						Weight left, right;
-						} gain;
-
-					gain.left=p0.m_Bucket.rbegin()->first;
-					gain.right=p1.m_Bucket.rbegin()->first;
-
-					// Move by gain
-					if(gain.left>gain.right) moveRight(); else moveLeft();
-				}
-			}
+			from=m_Balance.forced(p0.GetSquare(),p1.GetSquare());
+			if(from<0) from=p0.m_Bucket.rbegin()->first>p1.m_Bucket.rbegin()->first?0:1;
 		}
 
+		// A move the balance rejects goes to the other side, the pass ends
+		// when neither is possible
+		if(!movable(from)) from=1-from;
+		if(!movable(from)) break;
 
-
+		if(from==0) moveRight(); else moveLeft();
 
  #ifdef  ALGORITHM_VERBOSE
 		p0.m_Bucket.dbg(0);
@@ -156,28 +163,51 @@ void Iteration::run()
 #ifdef  PRINT_PROGRESS
 		std::cout << "\rLl=" << Ll << " Lr=" << Lr << " T=" << (Ll+Lr) << std::flush;
 #endif//PRINT_PROGRESS
-		if(Solution::SolutionImproved(graph->bestSolution,p0.GetSquare(),p1.GetSquare(),p0.GetGain()+p1.GetGain())) {
+		const bool improved=m_Balance.accept(p0.GetSquare(),p1.GetSquare()) &&
+			Solution::SolutionImproved(graph->bestSolution,p0.GetSquare(),p1.GetSquare(),graph->m_Cost);
+
+		if(m_Journal)
+		{
+			m_Move.cut=graph->m_CutWeight;
+			m_Move.square[0]=p0.GetSquare();
+			m_Move.square[1]=p1.GetSquare();
+			m_Move.best=improved;
+			m_Journal->Add(m_Move);
+		}
+
+		if(improved) {
 
 			m_Improvement+=graph->bestSolution.Cut();
 
 			// Store best solution as current
-			graph->bestSolution=Solution(p0,p1,*graph->m_AllCells);
+			graph->bestSolution.Capture(*graph->m_AllCells,graph->m_Cost);
 
 			m_Improvement-=graph->bestSolution.Cut();
+
+			if(m_Progress) m_Progress->Best(graph->bestSolution.Cut(),p0.GetSquare(),p1.GetSquare());
 			}
 
 #ifdef  ALGORITHM_VERBOSE
 		std::cout << std::endl;
 #endif
 		}
+
+	// Also when the balance policy stopped the pass
+	if(!p0.m_Bucket.empty() || !p1.m_Bucket.empty())
+	{
+		p0.m_Bucket.Drain(p0.m_Locker);
+		p1.m_Bucket.Drain(p1.m_Locker);
+	}
 }
 
-void Iteration::moveCell(Partition* from,Partition* to)
+template<class P> void Iteration<P>::moveCell(Partition* from,Partition* to)
 {
 	CellList& tgCL = from->m_Bucket.rbegin()->second;
 	Weight topGain=from->m_Bucket.rbegin()->first;
 
-	Cell& cell=*tgCL.begin();
+	// Lifo ties put updated cells at the head, the cell is kept by its position
+	const CellList::Iterator top=tgCL.begin();
+	Cell& cell=*top;
 
 	#ifdef CHECK_LOGIC
 	if(cell.GetPartition()!=from)
@@ -201,14 +231,30 @@ void Iteration::moveCell(Partition* from,Partition* to)
 	std::cout << "MOVE "<< (from==&p0?"RIGHT":"LEFT");
 	std::cout << " Cell " << cell.GetName() << " Cell Gain=" << cell.GetGain() << " Bucket higher gain=" << topGain << std::endl;
 #endif
-	/*m_Improvement+=*/graph->UpdateGains(cell);
+	graph->template UpdateGains<P>(cell);
+
+	if(m_Journal)
+	{
+		m_Move.cell=cell.GetUnsignedId();
+		m_Move.gain=topGain;
+		m_Move.to=to==&p1;
+	}
 
 	// cell reference is not valid after moving the cell in this line
-	tgCL.TransferTo(tgCL.begin(),to->m_Locker,false);
+	tgCL.TransferTo(top,to->m_Locker,false);
 
 	if(tgCL.empty()) {
 		// Remove empty gain lists
 		from->m_Bucket.erase(topGain);
 		}
+
+	if(m_Journal)
+	{
+		m_Move.top[0]=p0.m_Bucket.empty()?MoveJournal::NoGain:p0.m_Bucket.rbegin()->first;
+		m_Move.top[1]=p1.m_Bucket.empty()?MoveJournal::NoGain:p1.m_Bucket.rbegin()->first;
+	}
 }
 
+template class Novorado::Partition::Iteration<DefaultPolicies>;
+template class Novorado::Partition::Iteration<UnitPolicies>;
+template class Novorado::Partition::Iteration<CutPolicies>;
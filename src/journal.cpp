@@ -0,0 +1,148 @@
+#include "journal.h"
+#include <cstring>
+
+using namespace Novorado::Partition;
+
+namespace
+{
+	const char Magic[8]={'K','L','F','M','M','O','V','E'};
+	constexpr uint32_t Version=2;
+
+	struct Header
+	{
+		char magic[8];
+		uint32_t version;
+		uint8_t index,weight,square,record;
+	};
+
+	Header header()
+	{
+		Header h;
+		std::memcpy(h.magic,Magic,sizeof(Magic));
+		h.version=Version;
+		h.index=sizeof(Index);
+		h.weight=sizeof(Weight);
+		h.square=sizeof(Square);
+		h.record=sizeof(MoveJournal::Record);
+		return h;
+	}
+}
+
+MoveJournal::MoveJournal(const string& fn):
+	m_File(fn,std::ios::binary|std::ios::trunc)
+{
+	if(!m_File) throw std::runtime_error("Cannot write journal '"+fn+"'");
+	const Header h=header();
+	m_File.write(reinterpret_cast<const char*>(&h),sizeof(h));
+
+	m_Block.reserve(BlockRecords);
+	m_Writer=std::thread([this]{ write(); });
+}
+
+MoveJournal::~MoveJournal()
+{
+	submit();
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stop=true;
+	}
+	m_Queued.notify_one();
+	m_Writer.join();
+}
+
+void MoveJournal::submit()
+{
+	if(m_Block.empty()) return;
+
+	std::vector<Record> next;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Queue.push_back(std::move(m_Block));
+		if(!m_Spare.empty())
+		{
+			next=std::move(m_Spare.back());
+			m_Spare.pop_back();
+		}
+	}
+	m_Queued.notify_one();
+
+	// Blocks are reused, the pass loop allocates while the writer falls behind only
+	m_Block=std::move(next);
+	m_Block.clear();
+	m_Block.reserve(BlockRecords);
+}
+
+void MoveJournal::write()
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	for(;;)
+	{
+		m_Queued.wait(lock,[&]{ return m_Stop || !m_Queue.empty(); });
+		if(m_Queue.empty()) break;
+
+		std::vector<Record> block=std::move(m_Queue.front());
+		m_Queue.pop_front();
+		m_Busy++;
+		lock.unlock();
+
+		m_File.write(reinterpret_cast<const char*>(block.data()),block.size()*sizeof(Record));
+		m_File.flush();
+
+		lock.lock();
+		m_Busy--;
+		if(!m_File) m_Failed=true;
+		block.clear();
+		m_Spare.push_back(std::move(block));
+		m_Written.notify_all();
+	}
+}
+
+void MoveJournal::Flush()
+{
+	submit();
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_Written.wait(lock,[&]{ return m_Queue.empty() && !m_Busy; });
+	if(m_Failed) throw std::runtime_error("Journal write failed");
+}
+
+MoveJournal::Summary MoveJournal::Summarize(const string& fn)
+{
+	std::ifstream f(fn,std::ios::binary);
+	if(!f) throw std::runtime_error("Cannot open journal '"+fn+"'");
+
+	Header h{},expected=header();
+	f.read(reinterpret_cast<char*>(&h),sizeof(h));
+	if(!f || std::memcmp(&h,&expected,sizeof(h)))
+	{
+		throw std::runtime_error("'"+fn+"' is not a move journal of this build");
+	}
+
+	Summary s;
+	std::vector<Record> pass; // moves of the pass being read
+	auto close=[&]()
+	{
+		if(pass.empty()) return;
+		Summary::Pass p;
+		p.moves=pass.size();
+		p.endCut=pass.back().cut;
+		for(size_t i=0;i<pass.size();i++)
+		{
+			if(!pass[i].best) continue;
+			p.bestPrefix=i+1;
+			p.bestCut=pass[i].cut;
+		}
+		for(size_t i=0;i<p.bestPrefix;i++) s.bestGains[pass[i].gain]++;
+		s.passes.push_back(p);
+		pass.clear();
+	};
+
+	for(Record r;f.read(reinterpret_cast<char*>(&r),sizeof(r));)
+	{
+		if(!pass.empty() && r.pass!=pass.back().pass) close();
+		pass.push_back(r);
+		s.moves++;
+		s.gains[r.gain]++;
+	}
+	close();
+	return s;
+}
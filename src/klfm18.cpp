@@ -14,21 +14,68 @@
 
 #include "klfm18.h"
 #include "iteration.h"
+#include "trace.h"
+#include <algorithm>
+#include <chrono>
 #include <sstream>
+#include <type_traits>
 
 using namespace Novorado::Partition;
 
-void KLFM::Partition()
+template<class P> void KLFM::Partition()
 {
+	KLFM_TRACE_SCOPE("KLFM::Partition");
+	const auto started=Clock::now();
+
 	InitializeLockers();
 
 	RandomDistribution(p0,p1);
 
-	FillBuckets();
+	FillBuckets<P>();
+
+	const uint32_t done=passes<P>(started);
+
+	m_PartitionTime=std::chrono::duration<double>(Clock::now()-started).count();
+	if(m_Progress) m_Progress->Pass(done,CutWeight(),false);
+}
+
+template<class P> void KLFM::Refine()
+{
+	KLFM_TRACE_SCOPE("KLFM::Refine");
+	const auto started=Clock::now();
+
+	SyncLockers();
+
+	FillBuckets<P>();
 
-	for(int iter_cnt=0;;iter_cnt++){
+	const uint32_t done=passes<P>(started);
 
-		Iteration step(this);
+	// The last pass did not improve, its best is the best found
+	bestSolution.WriteLockers(p0.m_Locker,p1.m_Locker);
+
+	m_PartitionTime=std::chrono::duration<double>(Clock::now()-started).count();
+	if(m_Progress) m_Progress->Pass(done,CutWeight(),false);
+}
+
+template<class P> uint32_t KLFM::passes(Clock::time_point started,uint32_t first)
+{
+	auto deadline=m_Deadline;
+	if(m_Budget>=0)
+	{
+		deadline=std::min(deadline,started+
+			std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(m_Budget)));
+	}
+
+	m_Converged=false;
+	uint32_t iter_cnt=first;
+	for(;;iter_cnt++){
+
+		if(m_Progress) m_Progress->Pass(iter_cnt,CutWeight(),true);
+		if(!m_CheckpointFile.empty()) save(iter_cnt);
+		GetMemoryStats();
+
+		if(m_Journal) m_Journal->NextPass();
+		Iteration<P> step(this,deadline,m_Progress,m_Journal);
 
 		step.run();
 
@@ -36,16 +83,86 @@ void KLFM::Partition()
 		std::cout << std::endl;
 		#endif // PRINT_PROGRESS
 
-		if(step.GetImprovement()<=0) break;
+		if(step.IsExpired() || step.IsCancelled())
+		{
+			// Back to the best prefix of the interrupted pass
+			KLFM_TRACE_SCOPE("Solution::WriteLockers");
+			bestSolution.WriteLockers(p0.m_Locker,p1.m_Locker);
+			break;
+		}
+
+		if(step.GetImprovement()<=0)
+		{
+			m_Converged=true;
+			break;
+		}
 
-		bestSolution.WriteLockers(p0.m_Locker,p1.m_Locker);
+		{
+			KLFM_TRACE_SCOPE("Solution::WriteLockers");
+			bestSolution.WriteLockers(p0.m_Locker,p1.m_Locker);
+		}
 
 		#ifdef PRINT_PROGRESS
 		std::cout << "ITERATION " << iter_cnt << ", IMPROVEMENT " << step.GetImprovement() << std::endl;
 		#endif
 		}
+
+	// Last checkpoint is on disk when the run returns
+	if(m_Saving.valid()) m_Saving.get();
+	if(m_Journal) m_Journal->Flush();
+	GetMemoryStats();
+
+	return iter_cnt;
+}
+
+void KLFM::save(uint32_t pass)
+{
+	KLFM_TRACE_SCOPE("KLFM::save");
+	// Capture is a copy of the locker order, the file is written while
+	// the next pass runs
+	Checkpoint cp;
+	cp.Capture(*this,pass);
+	if(m_Saving.valid()) m_Saving.get();
+	m_Saving=std::async(std::launch::async,[cp=std::move(cp),fn=m_CheckpointFile]{ cp.Write(fn); });
+}
+
+template<class P> void KLFM::Resume(const string& fn)
+{
+	KLFM_TRACE_SCOPE("KLFM::Resume");
+	const auto started=Clock::now();
+
+	Checkpoint cp;
+	cp.Read(fn);
+	cp.Restore(*this);
+	// Restore() fills the gains of the default objective
+	if(!std::is_same<P,DefaultPolicies>::value) FillBuckets<P>();
+
+	const uint32_t done=passes<P>(started,cp.pass);
+
+	m_PartitionTime=std::chrono::duration<double>(Clock::now()-started).count();
+	if(m_Progress) m_Progress->Pass(done,CutWeight(),false);
+}
+
+std::future<bool> KLFM::PartitionAsync()
+{
+	return std::async(std::launch::async,[this]{ Partition(); return m_Converged; });
 }
 
+std::future<bool> KLFM::RefineAsync()
+{
+	return std::async(std::launch::async,[this]{ Refine(); return m_Converged; });
+}
+
+template void KLFM::Partition<DefaultPolicies>();
+template void KLFM::Partition<UnitPolicies>();
+template void KLFM::Partition<CutPolicies>();
+template void KLFM::Refine<DefaultPolicies>();
+template void KLFM::Refine<UnitPolicies>();
+template void KLFM::Refine<CutPolicies>();
+template void KLFM::Resume<DefaultPolicies>(const string&);
+template void KLFM::Resume<UnitPolicies>(const string&);
+template void KLFM::Resume<CutPolicies>(const string&);
+
 #ifdef KLFM_TEST
 class Test6 : public NetlistHypergraph
 {
@@ -54,11 +171,11 @@ class Test6 : public NetlistHypergraph
    void printNetlist(){
         for(Cell& c:*m_AllCells) {
             std::cout << "Cell '"<< c.GetName() << "' #" << c.GetId() << " connects to " << std::flush;
-            for(std::list<Pin>::iterator j=c.m_Pins.begin();j!=c.m_Pins.end();j++){
+            for(auto j=c.m_Pins.begin();j!=c.m_Pins.end();j++){
                 if(!j->GetNet()) throw std::logic_error("No net is initialized");
                 Net& net = *j->GetNet();
                 std::cout << " pin " << j->GetName() << "-> net " << net.GetName() << " ";
-                for(std::vector<Pin*>::iterator ll=net.m_Pins.begin();ll!=net.m_Pins.end();ll++) {
+                for(auto ll=net.m_Pins.begin();ll!=net.m_Pins.end();ll++) {
                     if(!(*ll)->GetCell()) std::logic_error("No cell is initialized");
                     if(c.GetId()!=(*ll)->GetCell()->GetId())
                         std::cout << (*ll)->GetCell()->GetName() << ":" << (*ll)->GetName() << " ";
@@ -0,0 +1,159 @@
+#include "generator.h"
+#include "testbuilder.h"
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace Novorado::Partition;
+
+namespace
+{
+	struct Options
+	{
+		PlantedGenerator::Params gen;
+		string dir{"/tmp"};
+		string out; // generate only
+		bool keep{false};
+	};
+
+	// Generates, loads and partitions a netlist of <cells>, prints its row
+	void bench(Options o,size_t cells)
+	{
+		using Clock = KLFM::Clock;
+		o.gen.cells=cells;
+		const string fn=o.dir+"/klfm_bench_"+std::to_string(cells)+".net";
+		const auto planted=PlantedGenerator(o.gen).Write(fn);
+
+		// Loader and partitioner chatter stays out of the table
+		std::stringstream quiet;
+		auto* was=std::cout.rdbuf(quiet.rdbuf());
+
+		auto started=Clock::now();
+		auto g=TestBuilder(fn).H;
+		const double load=std::chrono::duration<double>(Clock::now()-started).count();
+		if(!o.keep) std::remove(fn.c_str());
+
+		// Large nets are left out of the gains, they are cut anyway
+		if(planted.largeNets) g->m_LargeNetThreshold=o.gen.maxNetSize;
+		std::srand(static_cast<unsigned>(o.gen.seed));
+		started=Clock::now();
+		g->Partition();
+		const double partition=std::chrono::duration<double>(Clock::now()-started).count();
+		const Weight cut=g->CutWeight();
+		const auto memory=g->GetMemoryStats();
+		std::cout.rdbuf(was);
+
+		rusage ru;
+		getrusage(RUSAGE_SELF,&ru);
+
+		std::cout << cells << '\t' << planted.nets << '\t' << planted.pins << '\t'
+			<< std::fixed << std::setprecision(3) << load << '\t' << partition << '\t'
+			<< cut << '\t' << planted.cut << '\t'
+			<< std::setprecision(2) << double(cut)/double(std::max<Weight>(1,planted.cut)) << '\t'
+			<< std::setprecision(1) << double(ru.ru_maxrss)/1024 << '\t'
+			<< double(memory.Peak())/(1024*1024) << std::endl;
+	}
+
+	bool option(Options& o,const string& kv)
+	{
+		const auto eq=kv.find('=');
+		if(eq==string::npos) return false;
+		const string key=kv.substr(0,eq);
+		std::stringstream v(kv.substr(eq+1));
+		auto& g=o.gen;
+		bool good=true;
+		if(key=="seed") good=!!(v >> g.seed);
+		else if(key=="nets") good=!!(v >> g.netsPerCell);
+		else if(key=="rent") good=!!(v >> g.rent);
+		else if(key=="exponent") good=!!(v >> g.exponent);
+		else if(key=="max") good=!!(v >> g.maxNetSize);
+		else if(key=="cut") good=!!(v >> g.cutNets);
+		else if(key=="fixed") good=!!(v >> g.fixed);
+		else if(key=="large") good=!!(v >> g.largeNets);
+		else if(key=="largesize") good=!!(v >> g.largeNetSize);
+		else if(key=="square") good=!!(v >> g.maxSquare);
+		else if(key=="dir") good=!!(v >> o.dir);
+		else if(key=="out") good=!!(v >> o.out);
+		else if(key=="keep") good=!!(v >> o.keep);
+		else good=false;
+		if(!good) throw std::runtime_error("Wrong option '"+kv+"'");
+		return true;
+	}
+}
+
+// klfm_bench [key=value ...] <cells> [<cells> ...]
+// Partitions planted netlists of the sizes given, each in a process of its own
+// so the peak RSS is of that size. Keys are the PlantedGenerator parameters:
+// seed, nets, rent, exponent, max, cut, fixed, large, largesize, square; dir
+// for the netlists and keep=1 to leave them there. With out=<file> the netlist
+// of the first size and its planted sides (<file>.part) are written only
+int main(int argc,char** argv)
+{
+	Options o;
+	std::vector<size_t> sizes;
+	try
+	{
+		for(int i=1;i<argc;i++)
+		{
+			if(option(o,argv[i])) continue;
+			std::stringstream v(argv[i]);
+			size_t n=0;
+			if(!(v >> n) || !v.eof()) throw std::runtime_error(string("Wrong size '")+argv[i]+"'");
+			sizes.push_back(n);
+		}
+		if(sizes.empty())
+		{
+			std::cerr << "usage: klfm_bench [key=value ...] <cells> [<cells> ...]" << std::endl;
+			return 2;
+		}
+
+		if(!o.out.empty())
+		{
+			o.gen.cells=sizes.front();
+			const auto p=PlantedGenerator(o.gen).Write(o.out,o.out+".part");
+			std::cout << o.out << ": " << p.cells << " cells, " << p.nets << " nets, "
+				<< p.pins << " pins, " << p.fixed << " fixed, planted cut " << p.cut << std::endl;
+			return 0;
+		}
+	}
+	catch(const std::exception& e)
+	{
+		std::cerr << "klfm_bench: " << e.what() << std::endl;
+		return 1;
+	}
+
+	std::cout << "cells\tnets\tpins\tload_s\tpart_s\tcut\tplanted\tratio\trss_mb\tpeak_mb" << std::endl;
+	int rv=0;
+	for(size_t n:sizes)
+	{
+		const pid_t pid=fork();
+		if(pid<0)
+		{
+			std::perror("klfm_bench: fork");
+			return 1;
+		}
+		if(!pid)
+		{
+			try
+			{
+				bench(o,n);
+			}
+			catch(const std::exception& e)
+			{
+				std::cerr << "klfm_bench: " << n << " cells: " << e.what() << std::endl;
+				std::_Exit(1);
+			}
+			std::cout.flush();
+			std::_Exit(0);
+		}
+		int status=0;
+		waitpid(pid,&status,0);
+		if(!WIFEXITED(status) || WEXITSTATUS(status)) rv=1;
+	}
+	return rv;
+}
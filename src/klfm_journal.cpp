@@ -0,0 +1,45 @@
+#include "journal.h"
+#include <iostream>
+
+using namespace Novorado::Partition;
+
+// klfm_journal <journal>
+// Summary of a move journal written by KLFM::SetJournal()
+int main(int argc,char** argv)
+{
+	if(argc!=2)
+	{
+		std::cerr << "usage: klfm_journal <journal>" << std::endl;
+		return 2;
+	}
+
+	try
+	{
+		const auto s=MoveJournal::Summarize(argv[1]);
+
+		std::cout << "moves " << s.moves << ", passes " << s.passes.size() << std::endl;
+		std::cout << "pass\tmoves\tbest\tat\tcut\tend" << std::endl;
+		for(size_t i=0;i<s.passes.size();i++)
+		{
+			const auto& p=s.passes[i];
+			std::cout << i << '\t' << p.moves << '\t' << p.bestPrefix << '\t';
+			if(p.bestPrefix) std::cout << (100*p.bestPrefix/p.moves) << "%\t" << p.bestCut;
+			else std::cout << "-\t-";
+			std::cout << '\t' << p.endCut << std::endl;
+		}
+
+		std::cout << "gain\tmoves\tkept" << std::endl;
+		for(const auto& g:s.gains)
+		{
+			auto kept=s.bestGains.find(g.first);
+			std::cout << g.first << '\t' << g.second << '\t'
+				<< (kept==s.bestGains.end()?0:kept->second) << std::endl;
+		}
+	}
+	catch(const std::exception& e)
+	{
+		std::cerr << "klfm_journal: " << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
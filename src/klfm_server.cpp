@@ -0,0 +1,32 @@
+#include "server.h"
+#include "testbuilder.h"
+#include <unistd.h>
+
+using namespace Novorado::Partition;
+
+// klfm_server [socket]
+// Serves requests on a Unix domain socket, or the frames of stdin/stdout
+int main(int argc,char** argv)
+{
+	PartitionServer server([](const std::string& fn){ return TestBuilder(fn).H; });
+
+	try
+	{
+		if(argc>1)
+		{
+			server.ServeUnix(argv[1]);
+		}
+		else
+		{
+			// Frames own stdout, messages of the loader go to stderr
+			std::cout.rdbuf(std::cerr.rdbuf());
+			server.Serve(dup(STDIN_FILENO),dup(STDOUT_FILENO));
+		}
+	}
+	catch(const std::exception& e)
+	{
+		std::cerr << "klfm_server: " << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
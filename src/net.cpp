@@ -7,7 +7,14 @@ using namespace Novorado::Partition;
 Net::Net()
 {
 	//ctor
-	SetId(-1);
+	SetId(InvalidIndex);
+	SetWeight(1.0);
+}
+
+Net::Net(std::pmr::memory_resource* arena):m_Pins(arena),m_CellIds(arena),m_PinCounts(arena)
+{
+	//ctor
+	SetId(InvalidIndex);
 	SetWeight(1.0);
 }
 
@@ -28,6 +35,9 @@ Net& Net::operator=(const Net& rhs)
 
 	SetWeight(rhs.GetWeight());
 	m_Pins=rhs.m_Pins;
+	m_CellIds=rhs.m_CellIds;
+	m_PinCounts=rhs.m_PinCounts;
+	m_Count=rhs.m_Count;
 	//assignment operator
 	return *this;
 }
@@ -35,6 +45,32 @@ Net& Net::operator=(const Net& rhs)
 void Net::AddPin(Pin* p)
 {
 	m_Pins.push_back(p);
+	m_CellIds.push_back(p->GetCell()->GetId());
+	m_Count+=p->GetCount();
+	if(p->GetCount()!=1 && m_PinCounts.empty()) m_PinCounts.assign(m_CellIds.size()-1,1);
+	if(!m_PinCounts.empty()) m_PinCounts.push_back(p->GetCount());
+}
+
+size_t Net::RemovePins(Index id)
+{
+	size_t k=0;
+	for(size_t i=0;i<m_Pins.size();i++)
+	{
+		if(m_CellIds[i]==id)
+		{
+			m_Count-=Count(i);
+			continue;
+		}
+		m_Pins[k]=m_Pins[i];
+		m_CellIds[k]=m_CellIds[i];
+		if(!m_PinCounts.empty()) m_PinCounts[k]=m_PinCounts[i];
+		k++;
+	}
+	const size_t removed=m_Pins.size()-k;
+	m_Pins.resize(k);
+	m_CellIds.resize(k);
+	if(!m_PinCounts.empty()) m_PinCounts.resize(k);
+	return removed;
 }
 
 auto Net::Dim(Partition* p)
@@ -29,7 +29,7 @@ Square Partition::GetSquare()
 	return m_Bucket.GetSquare()+m_Locker.GetSquare();
 }
 
-Weight Partition::GetGain()
+Cost Partition::GetGain()
 {
 	return m_Bucket.GetGain()+m_Locker.GetSumGain();
 }
@@ -3,7 +3,7 @@
 
 using namespace Novorado::Partition;
 
-Pin::Pin(const Pin& other) noexcept:Bridge::Id(other)
+Pin::Pin(const Pin& other) noexcept:Bridge::Id(other),m_Count(other.m_Count)
 {
 	//copy ctor
 	// SetCell(other.GetCell());
@@ -13,6 +13,7 @@ Pin::Pin(const Pin& other) noexcept:Bridge::Id(other)
 Pin& Pin::operator=(const Pin& rhs) noexcept
 {
 	Bridge::Id::operator=(rhs);
+	m_Count=rhs.m_Count;
 	//SetCell(rhs.GetCell());
 	//SetNet(rhs.GetNet());
 	return *this;
@@ -0,0 +1,265 @@
+#include "placer.h"
+#include "pin.h"
+#include "initial.h"
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <thread>
+#include <unordered_map>
+
+using namespace Novorado::Partition;
+
+namespace
+{
+	// Seed of the subproblem of region <i> of <level>
+	uint32_t seedOf(uint32_t seed,size_t level,size_t i)
+	{
+		std::uint64_t h=seed;
+		h=h*0x9E3779B97F4A7C15ull+level;
+		h=h*0x9E3779B97F4A7C15ull+i;
+		return static_cast<uint32_t>(h^(h>>32));
+	}
+}
+
+MinCutPlacer::MinCutPlacer(NetlistHypergraph& g,const Bridge::Rect& die):
+	MinCutPlacer(g,die,Params())
+{
+}
+
+MinCutPlacer::MinCutPlacer(NetlistHypergraph& g,const Bridge::Rect& die,const Params& p):
+	m_Graph(g),m_Die(die),m_Params(p)
+{
+	//ctor
+}
+
+void MinCutPlacer::Place()
+{
+	auto& cells=*m_Graph.m_AllCells;
+
+	m_Regions.assign(cells.size(),m_Die);
+	m_Levels=0;
+
+	std::vector<Region> level(1);
+	level[0].box=m_Die;
+	level[0].dir=m_Params.firstCut;
+	level[0].cells.reserve(cells.size());
+	for(Cell& c:cells) level[0].cells.push_back(&c);
+
+	unsigned int threads=m_Params.threads;
+	if(!threads) threads=std::max(1u,std::thread::hardware_concurrency());
+
+	while(!level.empty())
+	{
+		// Regions of the same level only read m_Regions, it is updated
+		// once the whole level is done, and draw from seeds of their own,
+		// thus results do not depend on scheduling
+		for(size_t i=0;i<level.size();i++) level[i].seed=seedOf(m_Params.seed,m_Levels,i);
+		std::vector<std::vector<Region>> children(level.size());
+		std::atomic<size_t> next{0};
+
+		auto worker=[&]()
+		{
+			for(size_t i=next++;i<level.size();i=next++)
+			{
+				if(level[i].cells.size()>m_Params.leafSize) children[i]=cut(level[i]);
+			}
+		};
+
+		std::vector<std::future<void>> pool;
+		for(unsigned int t=1;t<threads && t<level.size();t++)
+			pool.push_back(std::async(std::launch::async,worker));
+		worker();
+		for(auto& f:pool) f.get();
+
+		std::vector<Region> nextLevel;
+		for(auto& ch:children)
+		{
+			for(Region& r:ch)
+			{
+				for(Cell* c:r.cells) m_Regions[c->GetUnsignedId()]=r.box;
+				nextLevel.push_back(std::move(r));
+			}
+		}
+
+		if(!nextLevel.empty()) m_Levels++;
+		level.swap(nextLevel);
+	}
+}
+
+std::vector<MinCutPlacer::Region> MinCutPlacer::cut(const Region& r) const
+{
+	std::vector<Region> rv;
+
+	auto flip=[](CutLine::Direction d)
+	{
+		return d==CutLine::Direction::Vertical?
+			CutLine::Direction::Horizontal:CutLine::Direction::Vertical;
+	};
+
+	auto halves=[&](part& p)
+	{
+		std::vector<Region> h(2);
+		h[0].box=p.bin1.box;
+		h[1].box=p.bin2.box;
+		for(void* c:p.bin1) h[0].cells.push_back(static_cast<Cell*>(c));
+		for(void* c:p.bin2) h[1].cells.push_back(static_cast<Cell*>(c));
+		h[0].dir=h[1].dir=flip(r.dir);
+		return h;
+	};
+
+	part top;
+	if(!bisect(r,[this](const Cell& c) -> const Bridge::Rect& { return GetRegion(c); },top))
+		return rv;
+
+	rv=halves(top);
+
+	if(m_Params.mode==Mode::Quadrisection)
+	{
+		// Second cut sees the sibling half at its new place
+		std::unordered_map<const Cell*,const Bridge::Rect*> moved;
+		for(auto& h:rv) for(Cell* c:h.cells) moved[c]=&h.box;
+
+		auto lookup=[&](const Cell& c) -> const Bridge::Rect&
+		{
+			auto i=moved.find(&c);
+			return i==moved.end()?GetRegion(c):*i->second;
+		};
+
+		std::vector<Region> quads;
+		for(size_t i=0;i<rv.size();i++)
+		{
+			Region& h=rv[i];
+			h.seed=seedOf(r.seed,1,i);
+			part p;
+			if(h.cells.size()>m_Params.leafSize && bisect(h,lookup,p))
+			{
+				for(auto& q:halves(p)) quads.push_back(std::move(q));
+			}
+			else quads.push_back(h);
+		}
+		rv.swap(quads);
+	}
+
+	return rv;
+}
+
+bool MinCutPlacer::bisect(const Region& r,const Lookup& pos,part& result) const
+{
+	const bool vertical=r.dir==CutLine::Direction::Vertical;
+	const Coordinate lo=vertical?r.box.left():r.box.bottom();
+	const Coordinate span=vertical?r.box.width():r.box.height();
+
+	if(span<2) return false;
+
+	// Terminals are propagated against the region center line
+	const Coordinate center=CutLine(Bridge::Rect(r.box),r.dir).l;
+
+	std::unordered_map<Index,size_t> local;
+	for(Cell* c:r.cells) local.emplace(c->GetId(),local.size());
+
+	// Nets touching the region in id order, so the subproblem is reproducible
+	std::vector<Net*> touched;
+	for(Cell* c:r.cells) for(Pin& p:c->m_Pins) touched.push_back(p.GetNet());
+	std::sort(touched.begin(),touched.end(),
+		[](Net* a,Net* b){ return a->GetId()<b->GetId(); });
+	touched.erase(std::unique(touched.begin(),touched.end()),touched.end());
+
+	struct SubNet
+	{
+		Net* net;
+		size_t inner;
+		bool t0,t1;
+	};
+
+	std::vector<SubNet> subnets;
+	bool needT0=false,needT1=false;
+	for(Net* n:touched)
+	{
+		SubNet sn{n,0,false,false};
+		for(Pin* p:n->m_Pins)
+		{
+			const Cell& c=*p->GetCell();
+			if(local.count(c.GetId()))
+			{
+				sn.inner++;
+				continue;
+			}
+			const Bridge::Rect& at=pos(c);
+			Coordinate x=vertical?at.hCenter():at.vCenter();
+			if(x<center) sn.t0=true;
+				else if(x>center) sn.t1=true;
+		}
+		if(sn.inner+sn.t0+sn.t1<2) continue;
+		needT0|=sn.t0;
+		needT1|=sn.t1;
+		subnets.push_back(sn);
+	}
+
+	KLFM sub;
+	sub.Reserve(r.cells.size()+2,subnets.size());
+
+	for(Cell* c:r.cells)
+	{
+		Partition* side=nullptr;
+		if(c->IsFixed()) side=c->GetPartition()==&m_Graph.p1?&sub.p1:&sub.p0;
+		sub.AddCell(c->GetName(),c->GetSquare(),side);
+	}
+
+	Cell* t0=needT0?&sub.AddCell("__terminal0",0,&sub.p0):nullptr;
+	Cell* t1=needT1?&sub.AddCell("__terminal1",0,&sub.p1):nullptr;
+
+	for(const SubNet& sn:subnets)
+	{
+		Net& net=sub.AddNet(sn.net->GetName(),sn.net->GetWeight());
+		for(Pin* p:sn.net->m_Pins)
+		{
+			auto i=local.find(p->GetCell()->GetId());
+			if(i!=local.end()) sub.Connect((*sub.m_AllCells)[i->second],net,p->GetName());
+		}
+		const string tp="t"+std::to_string(net.GetId());
+		if(sn.t0) sub.Connect(*t0,net,tp);
+		if(sn.t1) sub.Connect(*t1,net,tp);
+	}
+
+	// Seeded start, std::rand of KLFM::Partition() is shared by the workers
+	InitialPartitioner::Params ip;
+	ip.seed=r.seed;
+	ip.tries=1;
+	ip.threads=1; // regions are the unit of parallelism
+	InitialPartitioner(sub).Apply(ip);
+	sub.Refine();
+
+	Square s0=0,s1=0;
+	for(size_t i=0;i<r.cells.size();i++)
+	{
+		Cell* c=r.cells[i];
+		if((*sub.m_AllCells)[i].GetPartition()==&sub.p0)
+		{
+			result.bin1.push_back(c);
+			s0+=c->GetSquare();
+		}
+		else
+		{
+			result.bin2.push_back(c);
+			s1+=c->GetSquare();
+		}
+	}
+
+	// Partitioner failed to split the region, keep it as a leaf
+	if(result.bin1.empty() || result.bin2.empty()) return false;
+
+	if(!s0 && !s1) s0=result.bin1.size(),s1=result.bin2.size();
+
+	// Cut line follows the area ratio of the two halves
+	Coordinate l=lo+static_cast<Coordinate>(static_cast<std::int64_t>(span)*s0/(s0+s1));
+	l=std::clamp(l,lo+1,lo+span-1);
+
+	result.cut.dir=r.dir;
+	result.cut.l=l;
+
+	Bridge::Rect r1,r2;
+	result.cut.split(r.box,r1,r2);
+	result.setRect(r1,r2);
+
+	return true;
+}
@@ -0,0 +1,226 @@
+#include "preprocess.h"
+#include "trace.h"
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+
+using namespace Novorado::Partition;
+
+namespace
+{
+	size_t hashCells(size_t seed,const std::vector<Index>& v)
+	{
+		size_t h=seed^v.size();
+		for(Index i:v) h^=std::hash<Index>()(i)+0x9e3779b9+(h<<6)+(h>>2);
+		return h;
+	}
+}
+
+Preprocessor::Preprocessor(NetlistHypergraph& g):
+	Preprocessor(g,Params())
+{
+}
+
+Preprocessor::Preprocessor(NetlistHypergraph& g,const Params& p):
+	m_Params(p)
+{
+	const size_t nc=g.m_AllCells->size(), nn=g.nets.size();
+
+	// Distinct cells of every net
+	std::vector<std::vector<Index>> netCells(nn);
+	for(size_t n=0;n<nn;n++)
+	{
+		const Net& net=g.nets[n];
+		m_Stats.pinsBefore+=net.Dim();
+		netCells[n].assign(net.m_CellIds.begin(),net.m_CellIds.end());
+		std::sort(netCells[n].begin(),netCells[n].end());
+		netCells[n].erase(std::unique(netCells[n].begin(),netCells[n].end()),netCells[n].end());
+	}
+
+	m_CellMap.resize(nc);
+	if(m_Params.clusterCells || m_Params.collapseFixed) cluster(g,netCells);
+	else
+	{
+		std::iota(m_CellMap.begin(),m_CellMap.end(),0);
+		m_Cells=m_CellMap;
+	}
+
+	auto isTerminal=[&](Index r)
+	{
+		return m_Params.collapseFixed && (*g.m_AllCells)[m_Cells[r]].IsFixed();
+	};
+
+	// Nets over reduced cells, parallel ones are merged into the first one
+	m_NetMap.assign(nn,InvalidIndex);
+	std::unordered_map<size_t,std::vector<Index>> byHash;
+	for(size_t n=0;n<nn;n++)
+	{
+		// A super-terminal is repeated once per fixed cell it stands for,
+		// Build gives it one pin with that count
+		std::vector<Index> cells;
+		cells.reserve(netCells[n].size());
+		for(Index c:netCells[n]) cells.push_back(m_CellMap[c]);
+		std::sort(cells.begin(),cells.end());
+		size_t distinct=0;
+		for(size_t i=0;i<cells.size();i++)
+		{
+			if(i && cells[i]==cells[i-1])
+			{
+				if(isTerminal(cells[i])) continue;
+				cells.erase(cells.begin()+i--);
+				continue;
+			}
+			distinct++;
+		}
+
+		if(distinct<2)
+		{
+			m_Stats.singlePinNets++;
+			continue;
+		}
+
+		auto& candidates=byHash[hashCells(0,cells)];
+		auto same=std::find_if(candidates.begin(),candidates.end(),
+			[&](Index r){ return m_NetCells[r]==cells; });
+		if(same!=candidates.end())
+		{
+			m_NetWeights[*same]+=g.nets[n].GetWeight();
+			m_NetMap[n]=*same;
+			m_Stats.parallelNets++;
+			continue;
+		}
+
+		m_NetMap[n]=static_cast<Index>(m_NetCells.size());
+		candidates.push_back(m_NetMap[n]);
+		m_Stats.pinsAfter+=distinct;
+		m_NetCells.push_back(std::move(cells));
+		m_NetWeights.push_back(g.nets[n].GetWeight());
+		m_NetNames.push_back(static_cast<Index>(n));
+	}
+}
+
+void Preprocessor::cluster(NetlistHypergraph& g,const std::vector<std::vector<Index>>& netCells)
+{
+	const size_t nc=g.m_AllCells->size();
+
+	// Signature of a cell: nets it can be cut from, in net order
+	std::vector<std::vector<Index>> cellNets(nc);
+	for(size_t n=0;n<netCells.size();n++)
+	{
+		if(netCells[n].size()<2) continue;
+		for(Index c:netCells[n]) cellNets[c].push_back(static_cast<Index>(n));
+	}
+
+	// 0 free, 1 fixed left, 2 fixed right
+	auto fixedSide=[&](Index c) -> size_t
+	{
+		const Cell& cell=(*g.m_AllCells)[c];
+		if(!cell.IsFixed()) return 0;
+		return cell.GetPartition()==&g.p1?2:1;
+	};
+
+	std::unordered_map<size_t,std::vector<Index>> byHash;
+	Index terminal[3]={InvalidIndex,InvalidIndex,InvalidIndex};
+	m_Cells.clear();
+	for(size_t i=0;i<nc;i++)
+	{
+		const Index c=static_cast<Index>(i);
+
+		// Fixed cells of a side are interchangeable for the cut
+		if(m_Params.collapseFixed && fixedSide(c))
+		{
+			Index& t=terminal[fixedSide(c)];
+			if(t!=InvalidIndex)
+			{
+				m_CellMap[c]=t;
+				m_Stats.collapsedFixed++;
+				continue;
+			}
+			t=m_CellMap[c]=static_cast<Index>(m_Cells.size());
+			m_Cells.push_back(c);
+			continue;
+		}
+
+		if(!m_Params.clusterCells)
+		{
+			m_CellMap[c]=static_cast<Index>(m_Cells.size());
+			m_Cells.push_back(c);
+			continue;
+		}
+
+		// Unconnected cells are kept apart, otherwise they would melt into one
+		if(!cellNets[c].empty())
+		{
+			auto& candidates=byHash[hashCells(fixedSide(c),cellNets[c])];
+			auto same=std::find_if(candidates.begin(),candidates.end(),[&](Index r)
+				{
+					const Index rep=m_Cells[r];
+					return fixedSide(rep)==fixedSide(c) && cellNets[rep]==cellNets[c];
+				});
+			if(same!=candidates.end())
+			{
+				m_CellMap[c]=*same;
+				m_Stats.clusteredCells++;
+				continue;
+			}
+			candidates.push_back(static_cast<Index>(m_Cells.size()));
+		}
+
+		m_CellMap[c]=static_cast<Index>(m_Cells.size());
+		m_Cells.push_back(c);
+	}
+}
+
+void Preprocessor::Build(NetlistHypergraph& from,NetlistHypergraph& to) const
+{
+	KLFM_TRACE_SCOPE("Preprocessor::Build");
+	#ifdef CHECK_LOGIC
+	if(!to.m_AllCells->empty() || !to.nets.empty())
+	{
+		throw std::logic_error("Reduced hypergraph has to be built into an empty one");
+	}
+	if(from.m_AllCells->size()!=m_CellMap.size() || from.nets.size()!=m_NetMap.size())
+	{
+		throw std::logic_error("Preprocessing was done for another hypergraph");
+	}
+	#endif // CHECK_LOGIC
+
+	to.Reserve(m_Cells.size(),m_NetCells.size());
+
+	std::vector<Square> area(m_Cells.size(),0);
+	for(size_t c=0;c<m_CellMap.size();c++) area[m_CellMap[c]]+=(*from.m_AllCells)[c].GetSquare();
+
+	for(size_t r=0;r<m_Cells.size();r++)
+	{
+		Cell& c=(*from.m_AllCells)[m_Cells[r]];
+		Partition* side=c.GetPartition()==&from.p1?&to.p1:&to.p0;
+		Cell& copy=to.AddCell(c.GetName(),area[r],c.IsFixed()?side:nullptr);
+		copy.SetPartition(side);
+	}
+	to.instances.init(to.m_AllCells->data(),to.m_AllCells->size());
+
+	// A reduced net has one pin per cell named after the net, the pin of a
+	// terminal counts the fixed cells it stands for
+	for(size_t r=0;r<m_NetCells.size();r++)
+	{
+		Net& net=to.AddNet(from.nets[m_NetNames[r]].GetName(),m_NetWeights[r]);
+		const auto& cells=m_NetCells[r];
+		net.Reserve(cells.size());
+		const string pinName="p"+std::to_string(r);
+		for(size_t i=0,j;i<cells.size();i=j)
+		{
+			for(j=i;j<cells.size() && cells[j]==cells[i];j++);
+			to.Connect((*to.m_AllCells)[cells[i]],net,pinName,static_cast<Index>(j-i));
+		}
+	}
+}
+
+void Preprocessor::WriteBack(NetlistHypergraph& reduced,NetlistHypergraph& original) const
+{
+	for(size_t c=0;c<m_CellMap.size();c++)
+	{
+		const Cell& r=(*reduced.m_AllCells)[m_CellMap[c]];
+		(*original.m_AllCells)[c].SetPartition(r.GetPartition()==&reduced.p1?&original.p1:&original.p0);
+	}
+	original.SyncLockers();
+}
@@ -0,0 +1,53 @@
+#include "progress.h"
+
+using namespace Novorado::Partition;
+
+Progress::Snapshot Progress::Get() const noexcept
+{
+	constexpr auto relaxed=std::memory_order_relaxed;
+	Snapshot s;
+	for(;;)
+	{
+		const uint32_t seq=m_Seq.load(std::memory_order_acquire);
+		if(seq&1) continue;
+		s.cost=m_Cost.load(relaxed);
+		s.cut=m_Cut.load(relaxed);
+		s.left=m_Left.load(relaxed);
+		s.right=m_Right.load(relaxed);
+		s.pass=m_Pass.load(relaxed);
+		s.running=m_Running.load(relaxed);
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if(m_Seq.load(relaxed)==seq) return s;
+	}
+}
+
+void Progress::Best(Cost cost,Square left,Square right) noexcept
+{
+	m_Last.cost=cost;
+	m_Last.left=left;
+	m_Last.right=right;
+	publish();
+}
+
+void Progress::Pass(uint32_t pass,Weight cut,bool running) noexcept
+{
+	m_Last.pass=pass;
+	m_Last.cut=cut;
+	m_Last.running=running;
+	publish();
+}
+
+void Progress::publish() noexcept
+{
+	constexpr auto relaxed=std::memory_order_relaxed;
+	const uint32_t seq=m_Seq.load(relaxed);
+	m_Seq.store(seq+1,relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	m_Cost.store(m_Last.cost,relaxed);
+	m_Cut.store(m_Last.cut,relaxed);
+	m_Left.store(m_Last.left,relaxed);
+	m_Right.store(m_Last.right,relaxed);
+	m_Pass.store(m_Last.pass,relaxed);
+	m_Running.store(m_Last.running,relaxed);
+	m_Seq.store(seq+2,std::memory_order_release);
+}
@@ -0,0 +1,167 @@
+#include "reorder.h"
+#include "trace.h"
+#include "pin.h"
+#include <algorithm>
+#include <numeric>
+
+using namespace Novorado::Partition;
+
+Reordering::Reordering(NetlistHypergraph& g,Method m)
+{
+	switch(m)
+	{
+		case Method::BFS: traverse(g,false); break;
+		case Method::RCM: traverse(g,true); break;
+		case Method::NetSorted: netSorted(g); break;
+	}
+	orderNets(g);
+}
+
+void Reordering::traverse(NetlistHypergraph& g,bool rcm)
+{
+	const size_t nc=g.m_AllCells->size(), nn=g.nets.size();
+
+	// Nets of every cell, compressed rows
+	std::vector<Index> start(nc+1,0),cellNets;
+	for(const Net& net:g.nets) for(Index c:net.m_CellIds) start[c+1]++;
+	std::partial_sum(start.begin(),start.end(),start.begin());
+	cellNets.resize(start[nc]);
+	std::vector<Index> fill(start.begin(),start.end()-1);
+	for(size_t n=0;n<nn;n++)
+		for(Index c:g.nets[n].m_CellIds) cellNets[fill[c]++]=static_cast<Index>(n);
+
+	auto degree=[&](Index c){ return start[c+1]-start[c]; };
+	auto byDegree=[&](Index a,Index b){ return degree(a)<degree(b); };
+
+	// Every component starts from its lowest degree cell, a cheap
+	// approximation of a peripheral one
+	std::vector<Index> seeds(nc);
+	std::iota(seeds.begin(),seeds.end(),0);
+	std::stable_sort(seeds.begin(),seeds.end(),byDegree);
+
+	std::vector<bool> visited(nc,false),expanded(nn,false);
+	m_CellOrder.clear();
+	m_CellOrder.reserve(nc);
+
+	for(Index s:seeds)
+	{
+		if(visited[s]) continue;
+		visited[s]=true;
+		m_CellOrder.push_back(s);
+
+		// The order itself is the queue, every net is expanded once
+		for(size_t head=m_CellOrder.size()-1;head<m_CellOrder.size();head++)
+		{
+			const Index c=m_CellOrder[head];
+			const size_t first=m_CellOrder.size();
+			for(Index k=start[c];k<start[c+1];k++)
+			{
+				const Index n=cellNets[k];
+				if(expanded[n]) continue;
+				expanded[n]=true;
+				for(Index x:g.nets[n].m_CellIds)
+				{
+					if(visited[x]) continue;
+					visited[x]=true;
+					m_CellOrder.push_back(x);
+				}
+			}
+			if(rcm) std::stable_sort(m_CellOrder.begin()+first,m_CellOrder.end(),byDegree);
+		}
+	}
+
+	if(rcm) std::reverse(m_CellOrder.begin(),m_CellOrder.end());
+}
+
+void Reordering::netSorted(NetlistHypergraph& g)
+{
+	const size_t nc=g.m_AllCells->size();
+
+	std::vector<Index> nets(g.nets.size());
+	std::iota(nets.begin(),nets.end(),0);
+	std::stable_sort(nets.begin(),nets.end(),[&](Index a,Index b)
+		{
+			return g.nets[a].m_CellIds.size()<g.nets[b].m_CellIds.size();
+		});
+
+	std::vector<bool> visited(nc,false);
+	m_CellOrder.clear();
+	m_CellOrder.reserve(nc);
+	for(Index n:nets)
+	{
+		for(Index c:g.nets[n].m_CellIds)
+		{
+			if(visited[c]) continue;
+			visited[c]=true;
+			m_CellOrder.push_back(c);
+		}
+	}
+
+	// Cells without pins keep their relative order at the end
+	for(size_t c=0;c<nc;c++) if(!visited[c]) m_CellOrder.push_back(static_cast<Index>(c));
+}
+
+void Reordering::orderNets(NetlistHypergraph& g)
+{
+	std::vector<Index> newId(m_CellOrder.size());
+	for(size_t i=0;i<m_CellOrder.size();i++) newId[m_CellOrder[i]]=static_cast<Index>(i);
+
+	std::vector<Index> key(g.nets.size(),InvalidIndex);
+	for(size_t n=0;n<g.nets.size();n++)
+		for(Index c:g.nets[n].m_CellIds) key[n]=std::min(key[n],newId[c]);
+
+	m_NetOrder.resize(g.nets.size());
+	std::iota(m_NetOrder.begin(),m_NetOrder.end(),0);
+	std::stable_sort(m_NetOrder.begin(),m_NetOrder.end(),
+		[&](Index a,Index b){ return key[a]<key[b]; });
+}
+
+void Reordering::Build(NetlistHypergraph& from,NetlistHypergraph& to) const
+{
+	KLFM_TRACE_SCOPE("Reordering::Build");
+	#ifdef CHECK_LOGIC
+	if(!to.m_AllCells->empty() || !to.nets.empty())
+	{
+		throw std::logic_error("Reordered hypergraph has to be built into an empty one");
+	}
+	if(from.m_AllCells->size()!=m_CellOrder.size() || from.nets.size()!=m_NetOrder.size())
+	{
+		throw std::logic_error("Ordering was computed for another hypergraph");
+	}
+	#endif // CHECK_LOGIC
+
+	to.Reserve(m_CellOrder.size(),m_NetOrder.size());
+
+	std::vector<Index> newId(m_CellOrder.size());
+	for(size_t i=0;i<m_CellOrder.size();i++)
+	{
+		Cell& c=(*from.m_AllCells)[m_CellOrder[i]];
+		Partition* side=c.GetPartition()==&from.p1?&to.p1:&to.p0;
+		Cell& copy=to.AddCell(c.GetName(),c.GetSquare(),c.IsFixed()?side:nullptr);
+		copy.SetPartition(side);
+		newId[m_CellOrder[i]]=static_cast<Index>(i);
+	}
+	to.instances.init(to.m_AllCells->data(),to.m_AllCells->size());
+
+	for(Index n:m_NetOrder)
+	{
+		Net& net=from.nets[n];
+		Net& copy=to.AddNet(net.GetName(),net.GetWeight());
+		copy.Reserve(net.Dim());
+		for(Pin* p:net.m_Pins)
+		{
+			to.Connect((*to.m_AllCells)[newId[p->GetCell()->GetUnsignedId()]],copy,p->GetName(),p->GetCount());
+		}
+	}
+}
+
+void Reordering::WriteBack(NetlistHypergraph& reordered,NetlistHypergraph& original) const
+{
+	for(size_t i=0;i<m_CellOrder.size();i++)
+	{
+		const Cell& c=(*reordered.m_AllCells)[i];
+		(*original.m_AllCells)[m_CellOrder[i]].SetPartition(
+			c.GetPartition()==&reordered.p1?&original.p1:&original.p0);
+	}
+	original.SyncLockers();
+}
@@ -0,0 +1,533 @@
+#include "server.h"
+#include "trace.h"
+#include "initial.h"
+#include "pin.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace Novorado::Partition;
+
+namespace
+{
+	// Larger frames are taken for garbage
+	constexpr uint32_t MaxFrame = 1u<<30;
+
+	struct Encoder
+	{
+		string data;
+
+		template<class T> void put(T v)
+		{
+			data.append(reinterpret_cast<const char*>(&v),sizeof(v));
+		}
+
+		void str(const string& s)
+		{
+			put(static_cast<uint32_t>(s.size()));
+			data+=s;
+		}
+
+		void sides(const std::vector<uint8_t>& s)
+		{
+			put(static_cast<uint64_t>(s.size()));
+			string bits((s.size()+7)/8,'\0');
+			for(size_t i=0;i<s.size();i++) if(s[i]) bits[i/8]|=static_cast<char>(1<<(i%8));
+			data+=bits;
+		}
+	};
+
+	struct Decoder
+	{
+		const string& data;
+		size_t pos{0};
+
+		void need(size_t n) const
+		{
+			if(data.size()-pos<n) throw std::runtime_error("Truncated message");
+		}
+
+		template<class T> T get()
+		{
+			need(sizeof(T));
+			T v;
+			std::memcpy(&v,data.data()+pos,sizeof(T));
+			pos+=sizeof(T);
+			return v;
+		}
+
+		string str()
+		{
+			const uint32_t n=get<uint32_t>();
+			need(n);
+			string rv=data.substr(pos,n);
+			pos+=n;
+			return rv;
+		}
+
+		std::vector<uint8_t> sides()
+		{
+			const uint64_t n=get<uint64_t>();
+			need((n+7)/8);
+			std::vector<uint8_t> rv(n);
+			for(size_t i=0;i<n;i++) rv[i]=(data[pos+i/8]>>(i%8))&1;
+			pos+=(n+7)/8;
+			return rv;
+		}
+	};
+
+	bool readFrame(std::istream& in,string& frame)
+	{
+		uint32_t n=0;
+		if(!in.read(reinterpret_cast<char*>(&n),sizeof(n))) return false;
+		if(n>MaxFrame) throw std::runtime_error("Frame too large");
+		frame.resize(n);
+		if(!in.read(&frame[0],n)) throw std::runtime_error("Truncated frame");
+		return true;
+	}
+
+	void writeFrame(std::ostream& out,const string& frame)
+	{
+		const uint32_t n=static_cast<uint32_t>(frame.size());
+		out.write(reinterpret_cast<const char*>(&n),sizeof(n));
+		out.write(frame.data(),n);
+		out.flush();
+	}
+
+	std::vector<uint8_t> sidesOf(const KLFM& g)
+	{
+		std::vector<uint8_t> rv;
+		rv.reserve(g.m_AllCells->size());
+		for(const Cell& c:*g.m_AllCells) rv.push_back(c.GetPartition()==&g.p1);
+		return rv;
+	}
+
+	void checkSides(const KLFM& g,const std::vector<uint8_t>& sides)
+	{
+		if(sides.size()!=g.m_AllCells->size())
+		{
+			throw std::runtime_error("Sides are given for "+std::to_string(sides.size())
+				+" cells, the netlist has "+std::to_string(g.m_AllCells->size()));
+		}
+	}
+}
+
+PartitionServer::PartitionServer(Loader loader,unsigned int threads):
+	m_Loader(std::move(loader))
+{
+	if(!threads) threads=std::max(1u,std::thread::hardware_concurrency());
+	m_QueueLimit=2*threads;
+	for(unsigned int t=0;t<threads;t++) m_Workers.emplace_back([this]{ work(); });
+}
+
+PartitionServer::~PartitionServer()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_QueueMutex);
+		m_Stop=true;
+	}
+	m_Ready.notify_all();
+	for(auto& t:m_Workers) t.join();
+}
+
+void PartitionServer::work()
+{
+	for(;;)
+	{
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(m_QueueMutex);
+			m_Ready.wait(lock,[this]{ return m_Stop || !m_Queue.empty(); });
+			if(m_Queue.empty()) return;
+			job=std::move(m_Queue.front());
+			m_Queue.pop_front();
+		}
+		m_Space.notify_one();
+
+		const string response=handle(job.request);
+		{
+			std::lock_guard<std::mutex> lock(job.from->writing);
+			writeFrame(job.from->out,response);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_QueueMutex);
+			job.from->inflight--;
+		}
+		m_Done.notify_all();
+	}
+}
+
+void PartitionServer::Add(const string& name,std::shared_ptr<KLFM> g)
+{
+	auto r=std::make_shared<Resident>();
+	r->graph=std::move(g);
+	std::unique_lock<std::shared_mutex> lock(m_Mutex);
+	m_Netlists[name]=r;
+}
+
+std::shared_ptr<PartitionServer::Resident> PartitionServer::find(const string& name)
+{
+	std::shared_lock<std::shared_mutex> lock(m_Mutex);
+	auto i=m_Netlists.find(name);
+	if(i==m_Netlists.end()) throw std::runtime_error("No netlist '"+name+"' is loaded");
+	return i->second;
+}
+
+string PartitionServer::handle(const string& request)
+{
+	KLFM_TRACE_SCOPE("PartitionServer::handle");
+	Decoder in{request};
+	Encoder out;
+	uint32_t id=0;
+	try
+	{
+		id=in.get<uint32_t>();
+		const Op op=static_cast<Op>(in.get<uint8_t>());
+		const string name=in.str();
+
+		Encoder result;
+		switch(op)
+		{
+			case Op::Load:
+			{
+				const string path=in.str();
+				if(!std::ifstream(path)) throw std::runtime_error("Cannot open netlist '"+path+"'");
+				auto g=m_Loader(path);
+				result.put(static_cast<uint64_t>(g->m_AllCells->size()));
+				result.put(static_cast<uint64_t>(g->nets.size()));
+				Add(name,std::move(g));
+				break;
+			}
+			case Op::Partition:
+			case Op::WarmStart:
+			{
+				// The job runs on a view of the resident netlist, which Reweight
+				// does not change meanwhile
+				auto r=find(name);
+				std::shared_lock<std::shared_mutex> lock(r->lock);
+				auto g=std::make_shared<KLFM>(r->graph);
+
+				if(op==Op::Partition)
+				{
+					InitialPartitioner::Params ip;
+					ip.seed=in.get<uint32_t>();
+					ip.threads=1; // requests are the unit of parallelism
+					g->SetTimeBudget(in.get<double>());
+					InitialPartitioner(*g).Apply(ip);
+				}
+				else
+				{
+					g->SetTimeBudget(in.get<double>());
+					auto sides=in.sides();
+					checkSides(*g,sides);
+					auto& cells=*g->m_AllCells;
+					for(size_t c=0;c<cells.size();c++)
+					{
+						if(!cells[c].IsFixed()) cells[c].SetPartition(sides[c]?&g->p1:&g->p0);
+					}
+				}
+				g->Refine();
+
+				result.put(static_cast<int64_t>(g->CutWeight()));
+				result.put(static_cast<uint8_t>(g->IsConverged()));
+				result.sides(sidesOf(*g));
+				break;
+			}
+			case Op::Reweight:
+			{
+				auto r=find(name);
+				std::unique_lock<std::shared_mutex> lock(r->lock);
+				auto& nets=r->graph->nets;
+				std::vector<std::pair<uint32_t,int64_t>> weights(in.get<uint32_t>());
+				for(auto& w:weights)
+				{
+					w.first=in.get<uint32_t>();
+					w.second=in.get<int64_t>();
+					if(w.first>=nets.size()) throw std::runtime_error("No net #"+std::to_string(w.first));
+					if(static_cast<Weight>(w.second)!=w.second)
+					{
+						throw std::overflow_error("Weight "+std::to_string(w.second)+" of net #"+
+							std::to_string(w.first)+" does not fit Weight, rebuild with WIDE=1");
+					}
+				}
+
+				// All or none, the gains of the new weights have to fit too
+				std::vector<Weight> before;
+				before.reserve(weights.size());
+				for(auto& w:weights)
+				{
+					before.push_back(nets[w.first].GetWeight());
+					nets[w.first].SetWeight(static_cast<Weight>(w.second));
+				}
+				try
+				{
+					r->graph->CheckLimits();
+				}
+				catch(...)
+				{
+					for(size_t i=weights.size();i-->0;) nets[weights[i].first].SetWeight(before[i]);
+					throw;
+				}
+				break;
+			}
+			case Op::Cut:
+			{
+				auto r=find(name);
+				auto sides=in.sides();
+				std::shared_lock<std::shared_mutex> lock(r->lock);
+				checkSides(*r->graph,sides);
+				result.put(static_cast<int64_t>(r->graph->CutWeight(sides)));
+				break;
+			}
+			default:
+				throw std::runtime_error("Unknown request "+std::to_string(int(op)));
+		}
+
+		out.put(id);
+		out.put(uint8_t(0));
+		out.data+=result.data;
+	}
+	catch(const std::exception& e)
+	{
+		out.data.clear();
+		out.put(id);
+		out.put(uint8_t(1));
+		out.str(e.what());
+	}
+	return out.data;
+}
+
+void PartitionServer::Serve(std::istream& in,std::ostream& out)
+{
+	Connection conn{out};
+	auto drain=[&]
+	{
+		std::unique_lock<std::mutex> lock(m_QueueMutex);
+		m_Done.wait(lock,[&]{ return !conn.inflight; });
+	};
+
+	try
+	{
+		for(string request;readFrame(in,request);)
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_QueueMutex);
+				m_Space.wait(lock,[this]{ return m_Queue.size()<m_QueueLimit; });
+				m_Queue.push_back(Job{std::move(request),&conn});
+				conn.inflight++;
+			}
+			m_Ready.notify_one();
+		}
+	}
+	catch(...)
+	{
+		// Jobs in flight still write to <out>
+		drain();
+		throw;
+	}
+	drain();
+}
+
+void PartitionServer::Serve(int in,int out)
+{
+	{
+		FdBuf ib(in),ob(out);
+		std::istream is(&ib);
+		std::ostream os(&ob);
+		Serve(is,os);
+	}
+	::close(in);
+	if(out!=in) ::close(out);
+}
+
+void PartitionServer::ServeUnix(const string& path,size_t connections)
+{
+	sockaddr_un addr{};
+	addr.sun_family=AF_UNIX;
+	if(path.size()>=sizeof(addr.sun_path)) throw std::runtime_error("Socket path '"+path+"' is too long");
+	std::strcpy(addr.sun_path,path.c_str());
+
+	const int s=::socket(AF_UNIX,SOCK_STREAM,0);
+	if(s<0) throw std::runtime_error(string("Cannot create socket: ")+std::strerror(errno));
+	::unlink(path.c_str());
+	if(::bind(s,reinterpret_cast<sockaddr*>(&addr),sizeof(addr)) || ::listen(s,16))
+	{
+		const int e=errno;
+		::close(s);
+		throw std::runtime_error("Cannot listen on '"+path+"': "+std::strerror(e));
+	}
+
+	std::vector<std::future<void>> served;
+	for(size_t n=0;!connections || n<connections;)
+	{
+		const int c=::accept(s,nullptr,nullptr);
+		if(c<0)
+		{
+			if(errno==EINTR) continue;
+			break;
+		}
+		served.push_back(std::async(std::launch::async,[this,c]{ Serve(c,c); }));
+		n++;
+	}
+	::close(s);
+	::unlink(path.c_str());
+	for(auto& f:served) f.get();
+}
+
+FdBuf::FdBuf(int fd):m_Fd(fd)
+{
+	setg(m_In,m_In,m_In);
+	setp(m_Out,m_Out+sizeof(m_Out));
+}
+
+FdBuf::~FdBuf()
+{
+	sync();
+}
+
+FdBuf::int_type FdBuf::underflow()
+{
+	ssize_t n;
+	do n=::read(m_Fd,m_In,sizeof(m_In)); while(n<0 && errno==EINTR);
+	if(n<=0) return traits_type::eof();
+	setg(m_In,m_In,m_In+n);
+	return traits_type::to_int_type(m_In[0]);
+}
+
+FdBuf::int_type FdBuf::overflow(int_type c)
+{
+	if(sync()) return traits_type::eof();
+	if(!traits_type::eq_int_type(c,traits_type::eof()))
+	{
+		*pptr()=traits_type::to_char_type(c);
+		pbump(1);
+	}
+	return traits_type::not_eof(c);
+}
+
+int FdBuf::sync()
+{
+	for(char* p=pbase();p<pptr();)
+	{
+		// A closed peer is an error, not SIGPIPE
+		ssize_t n=::send(m_Fd,p,pptr()-p,MSG_NOSIGNAL);
+		if(n<0 && errno==ENOTSOCK) n=::write(m_Fd,p,pptr()-p);
+		if(n<0 && errno==EINTR) continue;
+		if(n<=0) return -1;
+		p+=n;
+	}
+	setp(m_Out,m_Out+sizeof(m_Out));
+	return 0;
+}
+
+PartitionClient::PartitionClient(std::istream& in,std::ostream& out):
+	m_In(in),m_Out(out)
+{
+}
+
+uint32_t PartitionClient::send(PartitionServer::Op op,const string& fields)
+{
+	const uint32_t id=m_Next++;
+	Encoder e;
+	e.put(id);
+	e.put(static_cast<uint8_t>(op));
+	e.data+=fields;
+	writeFrame(m_Out,e.data);
+	m_Pending[id]=op;
+	return id;
+}
+
+uint32_t PartitionClient::Load(const string& name,const string& path)
+{
+	Encoder e;
+	e.str(name);
+	e.str(path);
+	return send(PartitionServer::Op::Load,e.data);
+}
+
+uint32_t PartitionClient::Partition(const string& name,uint32_t seed,double budget)
+{
+	Encoder e;
+	e.str(name);
+	e.put(seed);
+	e.put(budget);
+	return send(PartitionServer::Op::Partition,e.data);
+}
+
+uint32_t PartitionClient::WarmStart(const string& name,const std::vector<uint8_t>& sides,double budget)
+{
+	Encoder e;
+	e.str(name);
+	e.put(budget);
+	e.sides(sides);
+	return send(PartitionServer::Op::WarmStart,e.data);
+}
+
+uint32_t PartitionClient::Reweight(const string& name,const std::vector<std::pair<Index,int64_t>>& weights)
+{
+	Encoder e;
+	e.str(name);
+	e.put(static_cast<uint32_t>(weights.size()));
+	for(auto& w:weights)
+	{
+		e.put(static_cast<uint32_t>(w.first));
+		e.put(w.second);
+	}
+	return send(PartitionServer::Op::Reweight,e.data);
+}
+
+uint32_t PartitionClient::Cut(const string& name,const std::vector<uint8_t>& sides)
+{
+	Encoder e;
+	e.str(name);
+	e.sides(sides);
+	return send(PartitionServer::Op::Cut,e.data);
+}
+
+PartitionClient::Response PartitionClient::Read()
+{
+	string frame;
+	if(!readFrame(m_In,frame)) throw std::runtime_error("Server closed the connection");
+
+	Decoder d{frame};
+	Response r;
+	r.id=d.get<uint32_t>();
+	auto i=m_Pending.find(r.id);
+	if(i==m_Pending.end()) throw std::runtime_error("Response to an unknown request "+std::to_string(r.id));
+	r.op=i->second;
+	m_Pending.erase(i);
+
+	r.ok=!d.get<uint8_t>();
+	if(!r.ok)
+	{
+		r.error=d.str();
+		return r;
+	}
+
+	using Op=PartitionServer::Op;
+	switch(r.op)
+	{
+		case Op::Load:
+			r.cells=d.get<uint64_t>();
+			r.nets=d.get<uint64_t>();
+			break;
+		case Op::Partition:
+		case Op::WarmStart:
+			r.cut=static_cast<Weight>(d.get<int64_t>());
+			r.converged=d.get<uint8_t>();
+			r.sides=d.sides();
+			break;
+		case Op::Cut:
+			r.cut=static_cast<Weight>(d.get<int64_t>());
+			break;
+		case Op::Reweight:
+			break;
+	}
+	return r;
+}
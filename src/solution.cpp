@@ -6,17 +6,22 @@ using namespace Novorado::Partition;
 Solution::Solution(Partition& _p1,Partition& _p2):p1(&_p1),p2(&_p2)
 {
 	//ctor
-	g1=g2=0;
+	m_Cost=0;
 	s1=s2=0;
 	m_Recs.resize(0);
 }
 
-Solution::Solution(Partition& _p1,Partition& _p2,std::vector<Cell>& cells):
+Solution::Solution(Partition& _p1,Partition& _p2,std::vector<Cell>& cells,Cost cost):
 	p1(&_p1),
 	p2(&_p2)
 {
 	//ctor
-	g1=g2=0;
+	Capture(cells,cost);
+}
+
+void Solution::Capture(std::vector<Cell>& cells,Cost cost)
+{
+	m_Cost=cost;
 	s1=s2=0;
 	m_Recs.resize(cells.size());
 	for(int i=cells.size()-1;i>=0;i--) AddCell(&cells[i]);
@@ -30,8 +35,9 @@ Solution::~Solution()
 Solution& Solution::operator=(const Solution& s)
 {
 	m_Recs=s.m_Recs;
-	g1=s.g1;s1=s.s1;p1=s.p1;
-	g2=s.g2;s2=s.s2;p2=s.p2;
+	m_Cost=s.m_Cost;
+	s1=s.s1;p1=s.p1;
+	s2=s.s2;p2=s.p2;
 	return *this;
 }
 
@@ -41,10 +47,8 @@ void Solution::AddCell(Cell* c)
 	m_Recs[c->GetId()].p=c->GetPartition();
 	m_Recs[c->GetId()].cell=c;
 	if(c->GetPartition()==p1) {
-		g1+=c->GetGain();
 		s1+=c->GetSquare();
 		} else { if(c->GetPartition()==p2) {
-			g2+=c->GetGain();
 			s2+=c->GetSquare();
 			}
 			#ifdef CHECK_LOGIC
@@ -58,7 +62,7 @@ bool Solution::SolutionImproved(
 
 	Square s2_0, // new solution
 	Square s2_1,
-	Weight g2) // minimizing gain
+	Cost g2) // minimizing gain
 {
 	// Corner case, empty bin on either side
 	if(s2_0==0 || s2_1==0) return false;
@@ -91,12 +95,22 @@ void Solution::WriteLockers(CellList& l0, CellList& l1)
 		cell.SetGain(m_Recs[i].gain);
 		}
 
-	for(CellList::Iterator j=l0.begin();j!=l0.end();j++)
-		if(j->GetPartition()!=p1)
-			l0.TransferTo(j--,l1,false);
+	for(CellList::Iterator j=l0.begin();j!=l0.end();)
+	{
+		auto cur=j++;
+		if(cur->GetPartition()!=p1)
+			l0.TransferTo(cur,l1,false);
+	}
 
-	for(CellList::Iterator j=l1.begin();j!=l1.end();j++)
-		if(j->GetPartition()!=p2)
-			l1.TransferTo(j--,l0,false);
+	for(CellList::Iterator j=l1.begin();j!=l1.end();)
+	{
+		auto cur=j++;
+		if(cur->GetPartition()!=p2)
+			l1.TransferTo(cur,l0,false);
+	}
+
+	// Gains were written to the cells, sums are recomputed on demand
+	l0.InvalidateGain();
+	l1.InvalidateGain();
 }
 
@@ -4,12 +4,72 @@
 #include <sstream>
 #include "pin.h"
 #include "testbuilder.h"
+#include "placer.h"
+#include "iteration.h"
+#include "reorder.h"
+#include "preprocess.h"
+#include "components.h"
+#include "initial.h"
+#include "warmstart.h"
+#include "dynamic.h"
+#include "progress.h"
+#include "checkpoint.h"
+#include "batch.h"
+#include "server.h"
+#include "cache.h"
+#include "tuner.h"
+#include "trace.h"
+#include "journal.h"
+#include "generator.h"
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <new>
 #include <set>
 #include <algorithm>
+#include <cstring>
+#include <future>
+#include <map>
+#include <thread>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
 #include <gtest/gtest.h>
 
 using namespace Novorado::Partition;
 
+// Allocation counting hook, counts while enabled
+static std::atomic<bool> countAllocs{false};
+static std::atomic<size_t> allocCount{0};
+
+void* operator new(std::size_t sz)
+{
+	if(countAllocs) allocCount++;
+	if(void* p=std::malloc(sz?sz:1)) return p;
+	throw std::bad_alloc();
+}
+
+void* operator new(std::size_t sz,const std::nothrow_t&) noexcept
+{
+	if(countAllocs) allocCount++;
+	return std::malloc(sz?sz:1);
+}
+
+// Replacement pair, free() matches the malloc() above
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpragmas"
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p,std::size_t) noexcept
+{
+	std::free(p);
+}
+#pragma GCC diagnostic pop
+
 struct GraphWriter
 {
     class Files {
@@ -122,6 +182,1267 @@ TEST(graph6golden,KLFM)
 	EXPECT_TRUE(graph_test("6"));
 }
 
+TEST(graph6placement,MinCutPlacer)
+{
+	std::srand(2018);
+
+	auto Graph = std::move(TestBuilder("test/graph6/6.net").H);
+	const Bridge::Rect die(0,0,100,100);
+
+	MinCutPlacer placer(*Graph,die);
+	placer.Place();
+
+	EXPECT_GT(placer.GetLevels(),0u);
+
+	std::set<std::pair<Coordinate,Coordinate>> spots;
+	for(auto& cell:*Graph->m_AllCells)
+	{
+		const Bridge::Rect& r=placer.GetRegion(cell);
+		EXPECT_GE(r.left(),die.left());
+		EXPECT_LE(r.right(),die.right());
+		EXPECT_GE(r.bottom(),die.bottom());
+		EXPECT_LE(r.top(),die.top());
+		spots.emplace(placer.GetX(cell),placer.GetY(cell));
+	}
+	EXPECT_GT(spots.size(),2u);
+
+	// Fixed cells stay on their side of the first, vertical cut
+	const Cell *left=nullptr, *right=nullptr;
+	for(auto& cell:*Graph->m_AllCells)
+	{
+		if(cell.GetName()=="c8") left=&cell;
+		if(cell.GetName()=="c4") right=&cell;
+	}
+	ASSERT_TRUE(left && right);
+	EXPECT_LE(placer.GetRegion(*left).right(),placer.GetRegion(*right).left());
+}
+
+TEST(placement,IndependentOfThreads)
+{
+	const string fn="test/graph6/place.net";
+	PlantedGenerator::Params params;
+	params.cells=120;
+	PlantedGenerator(params).Write(fn);
+
+	auto place=[&](unsigned int threads,MinCutPlacer::Mode mode)
+	{
+		auto g=std::move(TestBuilder(fn).H);
+		MinCutPlacer::Params p;
+		p.threads=threads;
+		p.mode=mode;
+		MinCutPlacer placer(*g,Bridge::Rect(0,0,1000,1000),p);
+		placer.Place();
+		std::vector<std::array<Coordinate,4>> rv;
+		for(const auto& r:placer.GetRegions()) rv.push_back({r.left(),r.bottom(),r.right(),r.top()});
+		return rv;
+	};
+
+	for(auto mode:{MinCutPlacer::Mode::Bisection,MinCutPlacer::Mode::Quadrisection})
+	{
+		// std::rand is drawn by other threads meanwhile, it must not matter
+		std::srand(1);
+		const auto serial=place(1,mode);
+		std::srand(2);
+		EXPECT_EQ(place(4,mode),serial);
+	}
+	std::remove(fn.c_str());
+}
+
+// Weight of nets having cells on both sides
+static Weight cutWeight(NetlistHypergraph& g)
+{
+	Weight rv=0;
+	for(Net& net:g.nets)
+	{
+		std::set<Partition*> sides;
+		for(Pin* p:net.m_Pins) sides.insert(p->GetCell()->GetPartition());
+		if(sides.size()>1) rv+=net.GetWeight();
+	}
+	return rv;
+}
+
+// Objective minimized by KLFM, the sum of cell gains of FillBuckets
+static std::int64_t pinPairCost(NetlistHypergraph& g)
+{
+	std::int64_t rv=0;
+	for(Net& net:g.nets)
+	{
+		if(g.IsLargeNet(net)) continue;
+		std::int64_t n[2]={0,0};
+		for(Pin* p:net.m_Pins) n[p->GetCell()->GetPartition()==&g.p1]++;
+		rv+=net.GetWeight()*(n[0]+n[1]-(n[0]-n[1])*(n[0]-n[1]));
+	}
+	return rv;
+}
+
+static double areaRatio(NetlistHypergraph& g)
+{
+	const double a=g.p0.m_Locker.GetSquare(), b=g.p1.m_Locker.GetSquare();
+	return std::max(a,b)/std::min(a,b);
+}
+
+// Cost of the objective of <P> over the current sides
+template<class P> static Cost objectiveCost(NetlistHypergraph& g)
+{
+	Cost rv=0;
+	for(Net& net:g.nets)
+	{
+		if(g.IsLargeNet(net)) continue;
+		Index n[2]={0,0};
+		for(Index id:net.m_CellIds) n[g.m_State.side[id]]++;
+		rv+=P::Objective::cost(n[0],n[1],P::Weights::weight(net));
+	}
+	return rv;
+}
+
+template<class P> void policies_test()
+{
+	std::srand(2018);
+	auto Graph = std::move(TestBuilder("test/graph6/6.net").H);
+
+	// Partition() ends on the last pass, Refine() on its best
+	Graph->Partition<P>();
+	Graph->Refine<P>();
+
+	EXPECT_EQ(Graph->bestSolution.Cut(),objectiveCost<P>(*Graph));
+	EXPECT_LE(cutWeight(*Graph),4);
+	EXPECT_EQ(Graph->p0.m_Locker.size()+Graph->p1.m_Locker.size(),Graph->m_AllCells->size());
+	for(auto& cell:*Graph->m_AllCells)
+	{
+		if(cell.GetName()=="c8") { EXPECT_EQ(cell.GetPartition(),&Graph->p0); }
+		if(cell.GetName()=="c4") { EXPECT_EQ(cell.GetPartition(),&Graph->p1); }
+	}
+	EXPECT_LE(std::max(Graph->p0.m_Locker.size(),Graph->p1.m_Locker.size()),5u);
+}
+
+TEST(graph6policies,UnitWeights)
+{
+	policies_test<UnitPolicies>();
+}
+
+TEST(graph6policies,CutNetsStrictBound)
+{
+	policies_test<CutPolicies>();
+
+	std::srand(2018);
+	auto Graph = std::move(TestBuilder("test/graph6/6.net").H);
+	Graph->Partition<CutPolicies>();
+	Graph->Refine<CutPolicies>();
+	EXPECT_EQ(Graph->bestSolution.Cut(),cutWeight(*Graph));
+}
+
+TEST(policies,PinPairCostIsWide)
+{
+	// Unit net of 93k pins on one side, over 32 bits
+	const Cost pairs=PinPairs::cost(93000,0,1);
+	EXPECT_EQ(pairs,Cost(93000)-Cost(93000)*93000);
+	EXPECT_LT(pairs,Cost(std::numeric_limits<int32_t>::min()));
+
+	std::srand(2018);
+	auto Graph = std::move(TestBuilder("test/graph6/6.net").H);
+	Graph->Partition();
+	Graph->Refine();
+	EXPECT_EQ(Graph->bestSolution.Cut(),pinPairCost(*Graph));
+	EXPECT_EQ(Graph->bestSolution.Cut(),Graph->p0.GetGain()+Graph->p1.GetGain());
+}
+
+TEST(graph6alloc,PassLoopDoesNotAllocate)
+{
+	std::srand(2018);
+	auto Graph = std::move(TestBuilder("test/graph6/6.net").H);
+
+	Graph->InitializeLockers();
+	RandomDistribution(Graph->p0,Graph->p1);
+	Graph->FillBuckets();
+	{
+		Iteration warmup(Graph.get());
+		warmup.run();
+	}
+	Graph->bestSolution.WriteLockers(Graph->p0.m_Locker,Graph->p1.m_Locker);
+
+	allocCount=0;
+	countAllocs=true;
+	{
+		Iteration step(Graph.get());
+		step.run();
+	}
+	countAllocs=false;
+
+	EXPECT_EQ(allocCount,0u);
+}
+
+TEST(graph6reorder,KeepsNamesAndCut)
+{
+	using Method=Reordering::Method;
+	for(Method m:{Method::BFS,Method::RCM,Method::NetSorted})
+	{
+		auto Graph = std::move(TestBuilder("test/graph6/6.net").H);
+		Reordering order(*Graph,m);
+
+		KLFM copy;
+		order.Build(*Graph,copy);
+
+		ASSERT_EQ(copy.m_AllCells->size(),Graph->m_AllCells->size());
+		ASSERT_EQ(copy.nets.size(),Graph->nets.size());
+		for(size_t i=0;i<copy.m_AllCells->size();i++)
+		{
+			const Cell& c=(*copy.m_AllCells)[i];
+			const Cell& o=(*Graph->m_AllCells)[order.OriginalCell(static_cast<Index>(i))];
+			EXPECT_EQ(c.GetName(),o.GetName());
+			EXPECT_EQ(c.IsFixed(),o.IsFixed());
+			EXPECT_EQ(c.GetPartition()==&copy.p1,o.GetPartition()==&Graph->p1);
+		}
+		for(size_t i=0;i<copy.nets.size();i++)
+		{
+			const Net& o=Graph->nets[order.OriginalNet(static_cast<Index>(i))];
+			EXPECT_EQ(copy.nets[i].GetName(),o.GetName());
+			EXPECT_EQ(copy.nets[i].Dim(),o.Dim());
+		}
+
+		std::srand(2018);
+		copy.Partition<UnitPolicies>();
+		const Weight cost=copy.CutWeight();
+		order.WriteBack(copy,*Graph);
+		EXPECT_EQ(cutWeight(*Graph),cost);
+	}
+}
+
+// Chain of 2-pin nets over <n> cells, optionally with a net over all of them
+static void chain(KLFM& g,size_t n,bool clock)
+{
+	g.Reserve(n,n);
+	for(size_t i=0;i<n;i++) g.AddCell("c"+std::to_string(i),1);
+	for(size_t i=0;i+1<n;i++)
+	{
+		Net& net=g.AddNet("n"+std::to_string(i));
+		g.Connect((*g.m_AllCells)[i],net,"a");
+		g.Connect((*g.m_AllCells)[i+1],net,"b");
+	}
+	if(clock)
+	{
+		Net& net=g.AddNet("clk");
+		for(Cell& c:*g.m_AllCells) g.Connect(c,net,"ck");
+	}
+	// Left half on p0, right half on p1
+	for(size_t i=n/2;i<n;i++) (*g.m_AllCells)[i].SetPartition(&g.p1);
+}
+
+TEST(largenets,ExcludedFromGains)
+{
+	KLFM plain,clocked;
+	chain(plain,8,false);
+	chain(clocked,8,true);
+	clocked.m_LargeNetThreshold=4;
+
+	for(KLFM* g:{&plain,&clocked})
+	{
+		g->InitializeLockers();
+		g->FillBuckets();
+	}
+	for(size_t i=0;i<8;i++)
+	{
+		EXPECT_EQ((*clocked.m_AllCells)[i].GetGain(),(*plain.m_AllCells)[i].GetGain());
+	}
+
+	std::ofstream none;
+	auto stat=clocked.GetStats(none,false);
+	EXPECT_EQ(stat.m_LargeNets,1);
+	EXPECT_EQ(stat.m_LargeCut,1);
+	EXPECT_EQ(stat.m_NetCut,2);
+
+	// Large nets are not in the cost, CutWeight() has the clock too
+	clocked.Refine<CutPolicies>();
+	EXPECT_EQ(clocked.bestSolution.Cut(),1);
+	EXPECT_EQ(clocked.CutWeight(),2);
+}
+
+TEST(preprocess,MergeRemoveCluster)
+{
+	KLFM g;
+	g.Reserve(6,7);
+	for(int i=0;i<6;i++) g.AddCell("c"+std::to_string(i),1);
+	auto net=[&](const string& name,Weight w,std::vector<int> cells)
+	{
+		Net& n=g.AddNet(name,w);
+		int k=0;
+		for(int c:cells) g.Connect((*g.m_AllCells)[c],n,name+std::to_string(k++));
+	};
+	net("n0",1,{0,1});
+	net("n1",2,{1,0}); // parallel to n0
+	net("n2",1,{2}); // single pin
+	net("n3",1,{0,2,3});
+	net("n4",1,{4,5,3});
+	net("n5",1,{4,5,2});
+	net("n6",1,{2,2}); // single cell
+	for(int i=3;i<6;i++) (*g.m_AllCells)[i].SetPartition(&g.p1);
+
+	for(bool clusterCells:{false,true})
+	{
+		Preprocessor::Params params;
+		params.clusterCells=clusterCells;
+		Preprocessor pre(g,params);
+		KLFM reduced;
+		pre.Build(g,reduced);
+
+		const auto& st=pre.GetStats();
+		EXPECT_EQ(st.singlePinNets,2u);
+		EXPECT_EQ(st.parallelNets,1u);
+		EXPECT_EQ(st.pinsBefore,16u);
+		EXPECT_EQ(reduced.nets.size(),4u);
+		EXPECT_EQ(pre.ReducedNet(1),pre.ReducedNet(0));
+		EXPECT_EQ(reduced.nets[pre.ReducedNet(0)].GetWeight(),3);
+		EXPECT_EQ(pre.ReducedNet(2),InvalidIndex);
+
+		if(clusterCells)
+		{
+			EXPECT_EQ(st.clusteredCells,1u);
+			EXPECT_EQ(pre.ReducedCell(4),pre.ReducedCell(5));
+			EXPECT_EQ((*reduced.m_AllCells)[pre.ReducedCell(4)].GetSquare(),2);
+			EXPECT_EQ(st.pinsAfter,9u);
+		}
+		else EXPECT_EQ(st.pinsAfter,11u);
+
+		reduced.Refine<CutPolicies>();
+		const Weight cost=reduced.CutWeight();
+		pre.WriteBack(reduced,g);
+		EXPECT_EQ(cutWeight(g),cost);
+	}
+}
+
+TEST(preprocess,CollapseFixed)
+{
+	// Chain of 10 cells, pads 10..13 fixed left, 14..15 fixed right
+	KLFM g;
+	g.Reserve(16,16);
+	for(int i=0;i<16;i++) g.AddCell("c"+std::to_string(i),1,i<10?nullptr:i<14?&g.p0:&g.p1);
+	auto link=[&](int a,int b)
+	{
+		Net& n=g.AddNet("n"+std::to_string(g.nets.size()));
+		g.Connect((*g.m_AllCells)[a],n,n.GetName()+"a");
+		g.Connect((*g.m_AllCells)[b],n,n.GetName()+"b");
+	};
+	for(int i=0;i<9;i++) link(i,i+1);
+	link(10,0); link(11,1); link(12,1); link(13,2);
+	link(14,8); link(15,9);
+	link(10,11); // pads only, never cut
+
+	std::srand(2018);
+	for(int k=0;k<4;k++)
+	{
+		for(int i=0;i<10;i++) (*g.m_AllCells)[i].SetPartition(std::rand()%2?&g.p1:&g.p0);
+
+		Preprocessor::Params params;
+		params.collapseFixed=true;
+		Preprocessor pre(g,params);
+		KLFM reduced;
+		pre.Build(g,reduced);
+
+		EXPECT_EQ(reduced.m_AllCells->size(),12u);
+		EXPECT_EQ(pre.GetStats().collapsedFixed,4u);
+		EXPECT_EQ(pre.ReducedCell(11),pre.ReducedCell(10));
+		EXPECT_EQ(pre.GetStats().parallelNets,1u); // pads 11 and 12 to cell 1
+		EXPECT_LT(pre.GetStats().pinsAfter,pre.GetStats().pinsBefore);
+		EXPECT_EQ(cutWeight(reduced),cutWeight(g));
+	}
+}
+
+TEST(preprocess,CollapseFixedKeepsMoves)
+{
+	// Grid of 40 cells, pads fixed on both sides, several on a net
+	auto grid=[](KLFM& g)
+	{
+		g.Reserve(48,100);
+		for(int i=0;i<48;i++) g.AddCell("c"+std::to_string(i),1+i%3,i<40?nullptr:i<44?&g.p0:&g.p1);
+		auto net=[&](std::vector<int> cells)
+		{
+			Net& n=g.AddNet("n"+std::to_string(g.nets.size()));
+			int k=0;
+			for(int c:cells) g.Connect((*g.m_AllCells)[c],n,n.GetName()+"_"+std::to_string(k++));
+		};
+		for(int i=0;i<40;i++)
+		{
+			if(i%8!=7) net({i,i+1});
+			if(i<32) net({i,i+8});
+		}
+		net({40,41,0}); net({42,43,8,16}); net({40,42});
+		net({44,45,7}); net({46,47,39,31}); net({44,47,23});
+		net({40,41,42,43,12,13});
+	};
+
+	for(unsigned seed:{1u,7u,2018u})
+	{
+		KLFM g;
+		grid(g);
+
+		Preprocessor::Params params;
+		params.collapseFixed=true;
+		Preprocessor pre(g,params);
+		KLFM reduced;
+		pre.Build(g,reduced);
+		EXPECT_EQ(reduced.m_AllCells->size(),42u);
+
+		// Pads of a side are one pin with a count: the loops scan 8 pins less
+		// for the same counts, the net of pads 40 and 42 alone is removed
+		size_t scanned=0,counted=0;
+		for(const Net& n:reduced.nets)
+		{
+			scanned+=n.m_CellIds.size();
+			counted+=n.Count();
+		}
+		EXPECT_EQ(scanned,pre.GetStats().pinsAfter);
+		EXPECT_EQ(counted,pre.GetStats().pinsBefore-2);
+		EXPECT_EQ(scanned,counted-8);
+		EXPECT_EQ(reduced.nets.back().Count(),6u);
+		EXPECT_EQ(reduced.nets.back().m_CellIds.size(),3u);
+
+		std::srand(seed);
+		reduced.Partition();
+		std::srand(seed);
+		g.Partition();
+
+		std::vector<Partition*> sides;
+		for(Cell& c:*g.m_AllCells) sides.push_back(c.GetPartition());
+		pre.WriteBack(reduced,g);
+		for(size_t i=0;i<sides.size();i++) EXPECT_EQ((*g.m_AllCells)[i].GetPartition(),sides[i]);
+		EXPECT_EQ(cutWeight(reduced),cutWeight(g));
+	}
+}
+
+// Three chains of 10 cells and six pairs
+static void chainsAndPairs(KLFM& g)
+{
+	g.Reserve(42,33);
+	for(int i=0;i<42;i++) g.AddCell("c"+std::to_string(i),1);
+	auto link=[&](int a,int b)
+	{
+		Net& n=g.AddNet("n"+std::to_string(g.nets.size()));
+		g.Connect((*g.m_AllCells)[a],n,n.GetName()+"a");
+		g.Connect((*g.m_AllCells)[b],n,n.GetName()+"b");
+	};
+	for(int c=0;c<3;c++) for(int i=0;i<9;i++) link(c*10+i,c*10+i+1);
+	for(int i=30;i<42;i+=2) link(i,i+1);
+}
+
+TEST(components,PackSmallPartitionLarge)
+{
+	KLFM g;
+	chainsAndPairs(g);
+
+	ComponentPartitioner::Params params;
+	params.minSize=8;
+	ComponentPartitioner cp(g,params);
+	cp.Partition();
+
+	EXPECT_EQ(cp.GetComponents(),9u);
+	EXPECT_EQ(cp.GetPartitioned(),3u);
+	EXPECT_EQ(cutWeight(g),3);
+	EXPECT_LE(areaRatio(g),1.0+SQUARE_TOLERANCE+1e-9);
+	for(int i=30;i<42;i+=2)
+	{
+		EXPECT_EQ((*g.m_AllCells)[i].GetPartition(),(*g.m_AllCells)[i+1].GetPartition());
+	}
+}
+
+TEST(components,StopsOnCancelAndDeadline)
+{
+	Progress caller;
+	Progress part;
+	part.Follow(&caller);
+	EXPECT_FALSE(part.IsCancelled());
+	caller.Cancel();
+	EXPECT_TRUE(part.IsCancelled());
+
+	// Stopped before any bisection, every component is packed whole
+	KLFM g;
+	chainsAndPairs(g);
+	ComponentPartitioner::Params params;
+	params.progress=&caller;
+	ComponentPartitioner cancelled(g,params);
+	cancelled.Partition();
+	EXPECT_EQ(cancelled.GetPartitioned(),0u);
+	EXPECT_EQ(cutWeight(g),0);
+
+	KLFM h;
+	chainsAndPairs(h);
+	ComponentPartitioner::Params late;
+	late.deadline=KLFM::Clock::now();
+	ComponentPartitioner expired(h,late);
+	expired.Partition();
+	EXPECT_EQ(expired.GetPartitioned(),0u);
+	EXPECT_EQ(cutWeight(h),0);
+}
+
+TEST(graph6initial,PortfolioThenRefine)
+{
+	auto Graph = std::move(TestBuilder("test/graph6/6.net").H);
+	InitialPartitioner init(*Graph);
+
+	using Method=InitialPartitioner::Method;
+	for(Method m:{Method::Shuffle,Method::Grow,Method::GreedyGain})
+	{
+		auto r=init.Run(m,7);
+		EXPECT_EQ(r.sides,init.Run(m,7).sides);
+		EXPECT_TRUE(r.balanced);
+		for(auto& cell:*Graph->m_AllCells)
+		{
+			if(cell.GetName()=="c8") { EXPECT_EQ(r.sides[cell.GetId()],0); }
+			if(cell.GetName()=="c4") { EXPECT_EQ(r.sides[cell.GetId()],1); }
+		}
+	}
+
+	auto best=init.Apply(InitialPartitioner::Params());
+	EXPECT_TRUE(best.balanced);
+	EXPECT_EQ(cutWeight(*Graph),best.cut);
+	EXPECT_EQ(Graph->p0.m_Locker.size()+Graph->p1.m_Locker.size(),Graph->m_AllCells->size());
+
+	// Refine never makes its objective worse nor leaves the balance
+	const auto cost=pinPairCost(*Graph);
+	const double ratio=areaRatio(*Graph);
+	Graph->Refine();
+	EXPECT_LE(pinPairCost(*Graph),cost);
+	EXPECT_LE(areaRatio(*Graph),ratio*(1.0+SQUARE_TOLERANCE));
+	EXPECT_EQ(cutWeight(*Graph),1); // golden, the portfolio start cuts 2
+	EXPECT_EQ(Graph->p0.m_Locker.size()+Graph->p1.m_Locker.size(),Graph->m_AllCells->size());
+}
+
+TEST(initial,GreedyScalesWithLargeNets)
+{
+	// Clock over every cell, no large net threshold: growing visits every
+	// net a bounded number of times, time grows about linearly
+	auto run=[](size_t n)
+	{
+		KLFM g;
+		chain(g,n,true);
+		InitialPartitioner init(g);
+		const auto started=std::chrono::steady_clock::now();
+		auto r=init.Run(InitialPartitioner::Method::GreedyGain,1);
+		const double t=std::chrono::duration<double>(std::chrono::steady_clock::now()-started).count();
+		EXPECT_TRUE(r.balanced);
+		EXPECT_LE(r.cut,3); // chain links and the clock
+		return t;
+	};
+	const double small=run(4000), large=run(16000);
+	EXPECT_LT(large,8*small+0.05);
+}
+
+TEST(graph6warmstart,FromGolden)
+{
+	auto Graph = std::move(TestBuilder("test/graph6/6.net").H);
+
+	WarmStart warm(*Graph);
+	warm.ReadLockers("test/graph6/GOLDEN/6_left","test/graph6/GOLDEN/6_right");
+	EXPECT_EQ(warm.GetMatched(),Graph->m_AllCells->size());
+	EXPECT_EQ(warm.GetUnknown(),0u);
+	warm.Apply();
+	EXPECT_TRUE(GraphCompare(*Graph,"test/graph6/GOLDEN/6"));
+
+	Graph->Refine();
+	EXPECT_LE(cutWeight(*Graph),4);
+
+	// Round trip through a .part file
+	warm.WritePart("test/graph6/6.part");
+	auto Again = std::move(TestBuilder("test/graph6/6.net").H);
+	WarmStart part(*Again);
+	part.ReadPart("test/graph6/6.part");
+	part.Apply();
+	for(size_t i=0;i<Graph->m_AllCells->size();i++)
+	{
+		EXPECT_EQ((*Again->m_AllCells)[i].GetPartition()==&Again->p1,
+			(*Graph->m_AllCells)[i].GetPartition()==&Graph->p1);
+	}
+
+	EXPECT_THROW(part.ReadPart("test/graph6/missing.part"),std::runtime_error);
+	std::remove("test/graph6/6.part");
+}
+
+// Pins point to their cell and net, nets list exactly the pins pointing to them
+static bool linked(NetlistHypergraph& g)
+{
+	size_t pins=0;
+	for(Cell& c:*g.m_AllCells)
+	{
+		for(Pin& p:c.m_Pins)
+		{
+			pins++;
+			if(p.GetCell()!=&c) return false;
+			auto& np=p.GetNet()->m_Pins;
+			if(std::find(np.begin(),np.end(),&p)==np.end()) return false;
+		}
+	}
+	for(Net& n:g.nets)
+	{
+		pins-=n.m_Pins.size();
+		for(size_t i=0;i<n.m_Pins.size();i++)
+		{
+			if(n.m_Pins[i]->GetNet()!=&n || n.m_CellIds[i]!=n.m_Pins[i]->GetCell()->GetId()) return false;
+		}
+	}
+	return !pins;
+}
+
+TEST(graph6dynamic,EcoUpdates)
+{
+	std::srand(2018);
+	auto Graph = std::move(TestBuilder("test/graph6/6.net").H);
+	Graph->Partition();
+
+	DynamicHypergraph dyn(*Graph);
+	EXPECT_EQ(dyn.GetCut(),cutWeight(*Graph));
+
+	// Storage is reserved for the file only, adding grows it
+	Index prev=dyn.AddCell("e0",1);
+	for(int i=1;i<12;i++)
+	{
+		const Index c=dyn.AddCell("e"+std::to_string(i),1);
+		const Index n=dyn.AddNet("en"+std::to_string(i),2);
+		dyn.Connect(prev,n,"o");
+		dyn.Connect(c,n,"i");
+		prev=c;
+	}
+	ASSERT_TRUE(linked(*Graph));
+	EXPECT_EQ(Graph->p0.m_Locker.size()+Graph->p1.m_Locker.size(),Graph->m_AllCells->size());
+	EXPECT_EQ(dyn.GetCut(),cutWeight(*Graph));
+
+	// Incremental gains match the ones computed from scratch
+	auto fromScratch=[&]()
+	{
+		DynamicHypergraph fresh(*Graph);
+		for(size_t c=0;c<Graph->m_AllCells->size();c++)
+		{
+			EXPECT_EQ(dyn.GetGain(static_cast<Index>(c)),fresh.GetGain(static_cast<Index>(c)));
+		}
+		for(size_t n=0;n<Graph->nets.size();n++)
+		{
+			EXPECT_EQ(dyn.GetCount(static_cast<Index>(n),1),fresh.GetCount(static_cast<Index>(n),1));
+		}
+	};
+
+	// Two pins of a cell on a net
+	const Index twice=dyn.AddNet("en12",3);
+	dyn.Connect(prev,twice,"o2");
+	dyn.Connect(prev,twice,"o3");
+	dyn.Connect(0,twice,"x");
+	dyn.SetWeight(twice,4);
+	dyn.SetWeight(0,5);
+	dyn.Disconnect(3,6);
+	dyn.RemoveCell(2);
+	dyn.SetSquare(5,3);
+	EXPECT_EQ(dyn.GetCut(),cutWeight(*Graph));
+	EXPECT_TRUE(linked(*Graph));
+	fromScratch();
+
+	const Weight before=dyn.GetCut();
+	EXPECT_LE(dyn.Refine(2),before);
+	EXPECT_EQ(dyn.GetCut(),cutWeight(*Graph));
+	fromScratch();
+
+	Square sq=0;
+	for(auto& c:*Graph->m_AllCells) sq+=c.GetSquare();
+	EXPECT_EQ(Graph->p0.m_Locker.GetSquare()+Graph->p1.m_Locker.GetSquare(),sq);
+
+	// Legacy passes still run on the edited hypergraph
+	Graph->Refine();
+	EXPECT_TRUE(linked(*Graph));
+}
+
+TEST(deadline,StopsAndRestoresBestPrefix)
+{
+	KLFM g;
+	chain(g,256,false);
+
+	// Expired before the first move, the pass is rolled back to its start
+	g.SetDeadline(KLFM::Clock::now());
+	g.Refine();
+	EXPECT_FALSE(g.IsConverged());
+	EXPECT_TRUE(g.p0.m_Bucket.empty() && g.p1.m_Bucket.empty());
+	EXPECT_EQ(g.p0.m_Locker.size()+g.p1.m_Locker.size(),g.m_AllCells->size());
+	EXPECT_EQ(g.p0.m_Locker.GetSquare()+g.p1.m_Locker.GetSquare(),256);
+	EXPECT_EQ(cutWeight(g),1);
+
+	// A budget spent at the start does the same, then unlimited runs converge
+	g.SetDeadline(KLFM::Clock::time_point::max());
+	g.SetTimeBudget(0);
+	g.Refine();
+	EXPECT_FALSE(g.IsConverged());
+	EXPECT_EQ(cutWeight(g),1);
+
+	g.SetTimeBudget(-1);
+	g.Refine();
+	EXPECT_TRUE(g.IsConverged());
+	EXPECT_LE(cutWeight(g),1);
+	EXPECT_EQ(g.p0.m_Locker.size()+g.p1.m_Locker.size(),g.m_AllCells->size());
+}
+
+TEST(async,SnapshotsAndCancel)
+{
+	KLFM g;
+	chain(g,1024,false);
+	Progress progress;
+	g.SetProgress(&progress);
+
+	// Cancelled before the first move, the start is kept
+	progress.Cancel();
+	EXPECT_FALSE(g.RefineAsync().get());
+	EXPECT_EQ(g.p0.m_Locker.size()+g.p1.m_Locker.size(),g.m_AllCells->size());
+	EXPECT_EQ(cutWeight(g),1);
+
+	// Snapshots read while the run goes on are whole
+	KLFM h;
+	chain(h,1024,false);
+	h.SetProgress(&progress);
+	progress.Reset();
+	auto run=h.PartitionAsync();
+	while(run.wait_for(std::chrono::milliseconds(0))!=std::future_status::ready)
+	{
+		auto s=progress.Get();
+		EXPECT_TRUE(s.left+s.right==1024 || s.left+s.right==0);
+	}
+	EXPECT_TRUE(run.get());
+
+	auto s=progress.Get();
+	EXPECT_FALSE(s.running);
+	EXPECT_GE(s.pass,1u);
+	EXPECT_EQ(s.cut,cutWeight(h));
+	EXPECT_EQ(h.CutWeight(),cutWeight(h));
+}
+
+TEST(checkpoint,ResumeReproducesRun)
+{
+	const string fn="test/graph6/chain.ckpt";
+	auto sides=[](KLFM& g)
+	{
+		std::vector<bool> rv;
+		for(Cell& c:*g.m_AllCells) rv.push_back(c.GetPartition()==&g.p1);
+		return rv;
+	};
+
+	std::srand(2018);
+	KLFM full;
+	chain(full,512,false);
+	full.SetCheckpoint(fn);
+	full.Partition();
+	EXPECT_TRUE(full.IsConverged());
+
+	// From the start of the last pass
+	Checkpoint last;
+	last.Read(fn);
+	EXPECT_GE(last.pass,1u);
+	KLFM tail;
+	chain(tail,512,false);
+	tail.Resume(fn);
+	EXPECT_EQ(sides(tail),sides(full));
+
+	// From the first pass of a run stopped at once
+	std::srand(2018);
+	KLFM stopped;
+	chain(stopped,512,false);
+	stopped.SetCheckpoint(fn);
+	stopped.SetDeadline(KLFM::Clock::now());
+	stopped.Partition();
+	EXPECT_FALSE(stopped.IsConverged());
+
+	KLFM resumed;
+	chain(resumed,512,false);
+	resumed.Resume(fn);
+	EXPECT_TRUE(resumed.IsConverged());
+	EXPECT_EQ(sides(resumed),sides(full));
+
+	KLFM other;
+	chain(other,256,false);
+	EXPECT_THROW(other.Resume(fn),std::runtime_error);
+	std::remove(fn.c_str());
+}
+
+TEST(batch,ManifestReport)
+{
+	{
+		std::ofstream m("test/graph6/batch.manifest");
+		m << "# graph6 twice and a missing netlist\n"
+			<< "test/graph6/6.net seed=1 output=test/graph6/batch.part\n"
+			<< "\n"
+			<< "test/graph6/6.net seed=7 budget=10 large=100 # one more\n"
+			<< "test/graph6/missing.net\n";
+	}
+
+	BatchRunner::Params params;
+	params.threads=3;
+	params.memory=1; // one job at a time
+	BatchRunner batch([](const string& fn){ return TestBuilder(fn).H; },params);
+	batch.ReadManifest("test/graph6/batch.manifest");
+	ASSERT_EQ(batch.GetJobs().size(),3u);
+	EXPECT_EQ(batch.GetJobs()[1].seed,7u);
+	EXPECT_EQ(batch.GetJobs()[1].large,100u);
+
+	auto& results=batch.Run();
+	for(int i=0;i<2;i++)
+	{
+		EXPECT_TRUE(results[i].ok);
+		EXPECT_EQ(results[i].cells,9u);
+		EXPECT_LE(results[i].cut,5);
+		EXPECT_EQ(results[i].left+results[i].right,9);
+	}
+	EXPECT_FALSE(results[2].ok);
+	EXPECT_FALSE(results[2].error.empty());
+
+	// Written sides give the cut reported
+	auto g=std::move(TestBuilder("test/graph6/6.net").H);
+	WarmStart warm(*g);
+	warm.ReadPart("test/graph6/batch.part");
+	warm.Apply();
+	EXPECT_EQ(cutWeight(*g),results[0].cut);
+
+	batch.WriteReport("test/graph6/batch.json");
+	std::ifstream r("test/graph6/batch.json");
+	std::stringstream report;
+	report << r.rdbuf();
+	EXPECT_NE(report.str().find("\"failed\": 1"),string::npos);
+
+	{
+		std::ofstream m("test/graph6/batch.manifest");
+		m << "test/graph6/6.net seed=x\n";
+	}
+	EXPECT_THROW(batch.ReadManifest("test/graph6/batch.manifest"),std::runtime_error);
+
+	for(auto fn:{"test/graph6/batch.manifest","test/graph6/batch.part","test/graph6/batch.json"}) std::remove(fn);
+}
+
+TEST(server,ResidentRequests)
+{
+	PartitionServer server([](const string& fn){ return TestBuilder(fn).H; },2);
+
+	// Requests are framed into one stream and answered into another
+	std::stringstream requests,responses;
+	PartitionClient client(responses,requests);
+	client.Load("g6","test/graph6/6.net");
+	server.Serve(requests,responses);
+	auto loaded=client.Read();
+	ASSERT_TRUE(loaded.ok);
+	EXPECT_EQ(loaded.cells,9u);
+	EXPECT_EQ(loaded.nets,10u);
+
+	requests.clear();
+	responses.clear();
+	const uint32_t a=client.Partition("g6",1), b=client.Partition("g6",7,10);
+	client.Load("bad","test/graph6/missing.net.gz");
+	client.Cut("nothing",{});
+	server.Serve(requests,responses);
+
+	std::map<uint32_t,PartitionClient::Response> got;
+	for(int i=0;i<4;i++)
+	{
+		auto r=client.Read();
+		got[r.id]=r;
+	}
+	for(uint32_t id:{a,b})
+	{
+		ASSERT_TRUE(got[id].ok);
+		EXPECT_EQ(got[id].sides.size(),9u);
+		EXPECT_LE(got[id].cut,5);
+	}
+	EXPECT_FALSE(got[a+3].ok);
+	EXPECT_NE(got[a+3].error.find("nothing"),string::npos);
+
+	// Over a Unix domain socket: cut of the returned sides, reweight, warm start
+	const string path="/tmp/klfm_test."+std::to_string(getpid())+".sock";
+	auto serving=std::async(std::launch::async,[&]{ server.ServeUnix(path,1); });
+	int fd=-1;
+	for(int tries=0;tries<500 && fd<0;tries++)
+	{
+		fd=socket(AF_UNIX,SOCK_STREAM,0);
+		sockaddr_un addr{};
+		addr.sun_family=AF_UNIX;
+		std::strcpy(addr.sun_path,path.c_str());
+		if(connect(fd,reinterpret_cast<sockaddr*>(&addr),sizeof(addr)))
+		{
+			close(fd);
+			fd=-1;
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+	}
+	ASSERT_GE(fd,0);
+	{
+		FdBuf ib(fd),ob(fd);
+		std::istream in(&ib);
+		std::ostream out(&ob);
+		PartitionClient remote(in,out);
+
+		remote.Cut("g6",got[a].sides);
+		auto cut=remote.Read();
+		ASSERT_TRUE(cut.ok);
+		EXPECT_EQ(cut.cut,got[a].cut);
+
+		remote.Reweight("g6",{{0,10}});
+		EXPECT_TRUE(remote.Read().ok);
+		// Rejected as a whole, the weight of net 0 stays 10
+		remote.Reweight("g6",{{1,3},{0,std::numeric_limits<int64_t>::max()}});
+		EXPECT_FALSE(remote.Read().ok);
+		remote.Cut("g6",got[a].sides);
+		const Weight reweighted=remote.Read().cut;
+		remote.Reweight("g6",{{0,10}});
+		EXPECT_TRUE(remote.Read().ok);
+		remote.Cut("g6",got[a].sides);
+		EXPECT_EQ(remote.Read().cut,reweighted);
+
+		remote.WarmStart("g6",got[a].sides);
+		auto warm=remote.Read();
+		ASSERT_TRUE(warm.ok);
+		remote.Cut("g6",warm.sides);
+		EXPECT_EQ(remote.Read().cut,warm.cut);
+	}
+	shutdown(fd,SHUT_RDWR);
+	close(fd);
+	serving.get();
+}
+
+TEST(server,ViewSharesNetlist)
+{
+	std::shared_ptr<KLFM> resident=TestBuilder("test/graph6/6.net").H;
+	const auto sides=resident->m_State.side;
+
+	// Views refine from the resident sides as a copy would, the resident
+	// netlist is not touched
+	auto expected=TestBuilder("test/graph6/6.net").H;
+	expected->Refine();
+	KLFM a(resident),b(resident);
+	a.Refine();
+	b.Refine();
+	EXPECT_EQ(a.CutWeight(),expected->CutWeight());
+	EXPECT_EQ(a.m_State.side,expected->m_State.side);
+	EXPECT_EQ(b.m_State.side,a.m_State.side);
+	EXPECT_EQ(&a.nets,&resident->nets);
+	EXPECT_EQ(resident->m_State.side,sides);
+	EXPECT_LT(a.GetMemoryStats().topology.current,resident->GetMemoryStats().topology.current);
+}
+
+TEST(cache,ReuseVerifiedResults)
+{
+	const string dir="test/graph6/cache";
+	BatchRunner::Params params;
+	params.threads=1;
+	params.cache=dir;
+	BatchRunner batch([](const string& fn){ return TestBuilder(fn).H; },params);
+	BatchRunner::Job job;
+	job.input="test/graph6/6.net";
+	job.seed=3;
+	batch.Add(job);
+	batch.Add(job);
+	auto& results=batch.Run();
+	ASSERT_TRUE(results[0].ok && results[1].ok);
+	EXPECT_FALSE(results[0].cached);
+	EXPECT_TRUE(results[1].cached);
+	EXPECT_EQ(results[1].cut,results[0].cut);
+	auto stats=batch.GetCacheStats();
+	EXPECT_EQ(stats.hits,1u);
+	EXPECT_EQ(stats.stored,1u);
+
+	// Key follows the content and the parameters, not the names
+	auto g=std::move(TestBuilder("test/graph6/6.net").H);
+	const string key=ResultCache::Key(*g,"initial+refine seed=3");
+	EXPECT_EQ(key.size(),32u);
+	EXPECT_NE(key,ResultCache::Key(*g,"initial+refine seed=4"));
+	g->nets[0].SetName("renamed");
+	EXPECT_EQ(key,ResultCache::Key(*g,"initial+refine seed=3"));
+	g->nets[0].SetWeight(2);
+	EXPECT_NE(key,ResultCache::Key(*g,"initial+refine seed=3"));
+	g->nets[0].SetWeight(1);
+
+	ResultCache cache(dir);
+	EXPECT_TRUE(cache.Load(*g,key));
+	EXPECT_EQ(cutWeight(*g),results[0].cut);
+	EXPECT_EQ(g->p0.m_Locker.size()+g->p1.m_Locker.size(),9u);
+
+	// Magic, version, then cells, nets, pins and cut
+	auto patch=[&](std::streamoff at,int64_t v)
+	{
+		std::fstream f(dir+"/"+key+".klfm",std::ios::binary|std::ios::in|std::ios::out);
+		f.seekp(8+4+at*8);
+		f.write(reinterpret_cast<const char*>(&v),sizeof(v));
+	};
+
+	// A stored cut not matching the sides is rejected, so are other sizes
+	patch(3,100);
+	EXPECT_FALSE(cache.Load(*g,key));
+	EXPECT_EQ(cache.GetStats().rejected,1u);
+	patch(3,results[0].cut);
+	patch(2,0);
+	EXPECT_FALSE(cache.Load(*g,key));
+	EXPECT_EQ(cache.GetStats().rejected,2u);
+
+	std::remove((dir+"/"+key+".klfm").c_str());
+	rmdir(dir.c_str());
+}
+
+TEST(tuner,StatsAndChoice)
+{
+	auto Graph = std::move(TestBuilder("test/graph6/6.net").H);
+	Tuner small(*Graph);
+	const auto& s=small.GetStats();
+	EXPECT_EQ(s.cells,9u);
+	EXPECT_EQ(s.nets,10u);
+	EXPECT_EQ(s.pins,20u);
+	EXPECT_EQ(s.fixed,2u);
+	EXPECT_EQ(s.degree.max,3u);
+	EXPECT_EQ(s.netSize.max,2u);
+	EXPECT_EQ(s.components,1u);
+	EXPECT_EQ(s.largestComponent,9u);
+
+	auto config=small.Trial(small.Choose());
+	EXPECT_EQ(config.strategy,Tuner::Strategy::Portfolio);
+	EXPECT_EQ(config.largeNetThreshold,0u);
+	EXPECT_FALSE(config.initial.methods.empty());
+	small.Apply(config);
+	EXPECT_LE(cutWeight(*Graph),4);
+
+	// Two chains joined by a clock only
+	KLFM g;
+	g.Reserve(128,128);
+	for(int i=0;i<128;i++) g.AddCell("c"+std::to_string(i),1);
+	for(int i=0;i<128;i++)
+	{
+		if(i==63 || i==127) continue;
+		Net& net=g.AddNet("n"+std::to_string(i));
+		g.Connect((*g.m_AllCells)[i],net,"a");
+		g.Connect((*g.m_AllCells)[i+1],net,"b");
+	}
+	Net& clk=g.AddNet("clk");
+	for(Cell& c:*g.m_AllCells) g.Connect(c,clk,"ck");
+
+	Tuner split(g);
+	EXPECT_EQ(split.GetStats().components,1u);
+	config=split.Choose();
+	EXPECT_EQ(config.largeNetThreshold,64u);
+	EXPECT_EQ(config.strategy,Tuner::Strategy::Components);
+	split.Apply(config);
+	EXPECT_EQ(cutWeight(g),1);
+	EXPECT_EQ(g.p0.m_Locker.GetSquare(),64);
+}
+
+TEST(trace,ChromeJson)
+{
+	Trace::Clear();
+	{
+		Trace::Scope outer("test outer");
+		std::async(std::launch::async,[]{ Trace::Scope inner("test inner"); }).get();
+	}
+
+	std::stringstream json;
+	Trace::Dump(json);
+	const string s=json.str();
+	EXPECT_EQ(s.find("{\"traceEvents\":["),0u);
+	for(auto e:{"\"name\":\"test outer\",\"ph\":\"B\"","\"name\":\"test outer\",\"ph\":\"E\"",
+		"\"name\":\"test inner\",\"ph\":\"B\"","\"name\":\"test inner\",\"ph\":\"E\""})
+	{
+		EXPECT_NE(s.find(e),string::npos) << e;
+	}
+
+	// Every thread has a buffer of its own
+	auto tid=[&](const char* name)
+	{
+		auto at=s.find("\"tid\":",s.find(name));
+		return s.substr(at,s.find('}',at)-at);
+	};
+	EXPECT_NE(tid("test outer"),tid("test inner"));
+
+	Trace::Clear();
+	std::stringstream empty;
+	Trace::Dump(empty);
+	EXPECT_EQ(empty.str().find("test outer"),string::npos);
+}
+
+TEST(journal,SummaryOfPasses)
+{
+	const string fn="test/graph6/chain.moves";
+
+	std::srand(2018);
+	KLFM g;
+	chain(g,512,false);
+	{
+		MoveJournal journal(fn);
+		g.SetJournal(&journal);
+		g.Partition();
+	}
+	EXPECT_TRUE(g.IsConverged());
+
+	const auto s=MoveJournal::Summarize(fn);
+	ASSERT_GE(s.passes.size(),2u);
+	size_t kept=0;
+	for(const auto& p:s.passes)
+	{
+		// Every cell moves once a pass
+		EXPECT_EQ(p.moves,512u);
+		EXPECT_LE(p.bestPrefix,p.moves);
+		kept+=p.bestPrefix;
+	}
+	EXPECT_EQ(s.moves,512u*s.passes.size());
+	EXPECT_GT(s.passes.front().bestPrefix,0u);
+	// Converged on a pass without improvement
+	EXPECT_EQ(s.passes.back().bestPrefix,0u);
+	// Cut weight, not the objective: the last pass leaves the sides of the
+	// best prefix of the one before
+	EXPECT_EQ(s.passes[s.passes.size()-2].bestCut,g.CutWeight());
+
+	size_t moves=0,best=0;
+	for(const auto& h:s.gains) moves+=h.second;
+	for(const auto& h:s.bestGains) best+=h.second;
+	EXPECT_EQ(moves,s.moves);
+	EXPECT_EQ(best,kept);
+
+	std::remove(fn.c_str());
+	EXPECT_THROW(MoveJournal::Summarize(fn),std::runtime_error);
+	EXPECT_THROW(MoveJournal::Summarize("test/graph6/6.net"),std::runtime_error);
+}
+
+TEST(memory,AccountingAndLimit)
+{
+	std::srand(2018);
+	KLFM g;
+	chain(g,1024,false);
+	const auto loaded=g.GetMemoryStats();
+	EXPECT_GE(loaded.topology.current,1024*(sizeof(Cell)+sizeof(Net)+2*sizeof(Pin)));
+	EXPECT_EQ(loaded.names.current,0u); // short names are in the strings
+	EXPECT_GE(loaded.state.current,g.m_State.Bytes());
+	EXPECT_EQ(loaded.solutions.current,0u);
+
+	const auto estimate=g.EstimateRun();
+	g.Partition();
+	const auto run=g.GetMemoryStats();
+	EXPECT_EQ(run.topology.current,loaded.topology.current);
+	EXPECT_EQ(run.solutions.current,estimate.solutions.peak);
+	EXPECT_GT(run.buckets.peak,0u);
+	EXPECT_GE(run.Peak(),run.Current());
+	// Estimate is within 10% of the run
+	EXPECT_LE(run.Peak(),estimate.Peak()*11/10);
+	EXPECT_LE(estimate.Peak(),run.Peak()*11/10);
+
+	KLFM named;
+	named.Reserve(1,1);
+	const string name(100,'x');
+	Cell& cell=named.AddCell(name,1);
+	Net& net=named.AddNet(name);
+	named.Connect(cell,net,name);
+	EXPECT_EQ(named.GetMemoryStats().names.current,3*HeapBytes(name));
+	// Renaming is seen, names are not counted as they are added
+	cell.SetName(string(300,'y'));
+	EXPECT_EQ(named.GetMemoryStats().names.current,HeapBytes(cell.GetName())+2*HeapBytes(name));
+	EXPECT_GT(HeapBytes(cell.GetName()),HeapBytes(name));
+
+	// A job over the limit fails once loaded, before partitioning
+	BatchRunner::Params params;
+	params.threads=1;
+	params.limit=1;
+	BatchRunner batch([](const string& fn){ return TestBuilder(fn).H; },params);
+	batch.Add({"test/graph6/6.net"});
+	auto& results=batch.Run();
+	EXPECT_FALSE(results[0].ok);
+	EXPECT_NE(results[0].error.find("over the limit"),string::npos);
+	EXPECT_EQ(results[0].cells,9u);
+	EXPECT_EQ(results[0].partitionTime,0);
+
+	params.limit=0;
+	BatchRunner unlimited([](const string& fn){ return TestBuilder(fn).H; },params);
+	unlimited.Add({"test/graph6/6.net"});
+	EXPECT_TRUE(unlimited.Run()[0].ok);
+	EXPECT_GT(unlimited.GetResults()[0].peakMemory,0u);
+}
+
+TEST(generator,PlantedBisection)
+{
+	const string fn="test/graph6/planted.net", part="test/graph6/planted.part";
+	PlantedGenerator::Params params;
+	params.cells=2000;
+	params.fixed=0.01;
+	params.largeNets=2;
+	params.largeNetSize=100;
+	params.maxSquare=4;
+	const auto planted=PlantedGenerator(params).Write(fn,part);
+	EXPECT_EQ(planted.largeNets,2u);
+	EXPECT_GT(planted.fixed,0u);
+	EXPECT_GT(planted.cut,planted.largeNets);
+
+	auto g=std::move(TestBuilder(fn).H);
+	EXPECT_EQ(g->m_AllCells->size(),2000u);
+	EXPECT_EQ(g->nets.size(),planted.nets);
+	size_t fixed=0,pins=0;
+	for(Cell& c:*g->m_AllCells)
+	{
+		fixed+=c.IsFixed();
+		pins+=c.m_Pins.size();
+	}
+	EXPECT_EQ(fixed,planted.fixed);
+	EXPECT_EQ(pins,planted.pins);
+
+	// Planted sides give the cut reported
+	WarmStart warm(*g);
+	warm.ReadPart(part);
+	EXPECT_EQ(warm.GetMatched(),2000u);
+	warm.Apply();
+	EXPECT_EQ(g->CutWeight(),planted.cut);
+	EXPECT_EQ(g->p0.m_Locker.GetSquare(),planted.left);
+	EXPECT_EQ(g->p1.m_Locker.GetSquare(),planted.right);
+	// Refine keeps its objective and the balance from the planted start
+	g->m_LargeNetThreshold=params.maxNetSize;
+	const auto cost=pinPairCost(*g);
+	const double ratio=areaRatio(*g);
+	g->Refine();
+	EXPECT_LE(pinPairCost(*g),cost);
+	EXPECT_LE(areaRatio(*g),ratio*(1.0+SQUARE_TOLERANCE));
+
+	// Same seed, same netlist
+	auto read=[](const string& f)
+	{
+		std::ifstream in(f);
+		std::stringstream s;
+		s << in.rdbuf();
+		return s.str();
+	};
+	const string again="test/graph6/planted2.net";
+	PlantedGenerator(params).Write(again);
+	EXPECT_EQ(read(again),read(fn));
+
+	params.rent=0;
+	EXPECT_THROW(PlantedGenerator{params},std::invalid_argument);
+	for(auto f:{fn,part,again}) std::remove(f.c_str());
+}
+
+TEST(limits,CheckLimits)
+{
+	KLFM g;
+	g.Reserve(2,0);
+	g.AddCell("a",std::numeric_limits<Square>::max());
+	EXPECT_NO_THROW(g.CheckLimits());
+	g.AddCell("b",1);
+	EXPECT_THROW(g.CheckLimits(),std::overflow_error);
+
+	// Pin pairs of one net over 70000 cells add up beyond 32 bits
+	KLFM pads;
+	pads.Reserve(70000,1);
+	Net& net=pads.AddNet("pads");
+	for(int i=0;i<70000;i++)
+	{
+		Cell& c=pads.AddCell("c"+std::to_string(i),i<4,i<4?nullptr:&pads.p0);
+		if(i%2 && i<4) c.SetPartition(&pads.p1);
+		pads.Connect(c,net,"p");
+	}
+	EXPECT_NO_THROW(pads.CheckLimits());
+	pads.Refine();
+	EXPECT_LT(pinPairCost(pads),std::numeric_limits<std::int32_t>::min());
+	EXPECT_EQ(pads.p0.GetGain()+pads.p1.GetGain(),pinPairCost(pads));
+
+	// A cell on many heavy nets does not fit Weight
+	KLFM hub;
+	hub.Reserve(1001,1000);
+	hub.AddCell("hub",1);
+	for(int n=0;n<1000;n++)
+	{
+		Cell& c=hub.AddCell("c"+std::to_string(n),1);
+		Net& heavy=hub.AddNet("n"+std::to_string(n),1000000);
+		hub.Connect((*hub.m_AllCells)[0],heavy,"p"+std::to_string(n));
+		hub.Connect(c,heavy,"p");
+	}
+	if(sizeof(Weight)==4) EXPECT_THROW(hub.CheckLimits(),std::overflow_error);
+		else EXPECT_NO_THROW(hub.CheckLimits());
+}
+
 int main(int argc, char **argv)
 {
 	testing::InitGoogleTest(&argc, argv);
@@ -1,5 +1,6 @@
 #include "testbuilder.h"
 #include "pin.h"
+#include "trace.h"
 #include <sstream>
 #include <iostream>
 #include <fstream>
@@ -23,7 +24,7 @@ Pin &Novorado::Partition::TestBuilder::getNextPin(Cell &c1, const std::string &n
     return newPin;
 }
 
-void Novorado::Partition::TestBuilder::MakeCell(const std::string &cellName, const std::string &ssq, unsigned int &idx)
+Cell &Novorado::Partition::TestBuilder::MakeCell(const std::string &cellName, const std::string &ssq)
 {
 #ifdef CHECK_LOGIC
     if(m_name2cell.find(cellName)!=m_name2cell.end()) {
@@ -35,15 +36,11 @@ void Novorado::Partition::TestBuilder::MakeCell(const std::string &cellName, con
     Square sq=0;
     std::stringstream s(ssq);
     s >> sq;
-    Cell tmpCell;
-    tmpCell.SetId(idx++);
-    tmpCell.SetName(cellName);
-    tmpCell.SetSquare(sq);
-
-    H->m_AllCells->push_back(tmpCell);
-    H->instances.init(&(*H->m_AllCells)[0],H->m_AllCells->size());
-
-    H->m_AllCells->back().SetPartition(&H->p0);
+    if(s.fail()) {
+        std::stringstream msg;
+        msg << "Cell '" << cellName << "' square '" << ssq << "' does not fit at line " << current_ln;
+        throw std::overflow_error(msg.str());
+    }
 #ifdef CHECK_LOGIC
     if(!sq) {
         std::stringstream msg;
@@ -51,16 +48,16 @@ void Novorado::Partition::TestBuilder::MakeCell(const std::string &cellName, con
         throw std::logic_error(msg.str());
     }
 #endif
-    // Quadratic complexity readressing, bad.
-    for(auto& cell: *H->m_AllCells)
-    {
-        m_name2cell[cell.GetName()]=&cell;
-    }
+    // Storage is reserved, cell addresses are stable
+    Cell& cell=H->AddCell(cellName,sq);
+    m_name2cell[cellName]=&cell;
+    return cell;
 }
 
 void Novorado::Partition::TestBuilder::MakeNet(Net &net, const std::vector<std::string> &words, int idx)
 {
     net.SetId(idx);
+    net.Reserve((words.size()-2)/2);
     int cnt=0;
     Weight w;
     std::stringstream s;
@@ -77,6 +74,9 @@ void Novorado::Partition::TestBuilder::MakeNet(Net &net, const std::vector<std::
             break;
         case 1: s.str(str);
             s >> w;
+            if(s.fail()) {
+                throw std::overflow_error("Net '"+net.GetName()+"' weight '"+str+"' does not fit");
+            }
 #ifdef  ALGORITHM_VERBOSE
             std::cout << w << " " << std::flush;
 #endif
@@ -111,10 +111,14 @@ void Novorado::Partition::TestBuilder::MakePin(const std::string &cellName, cons
 
 void Novorado::Partition::TestBuilder::ReadGraphFromFile(const std::string &fn)
 {
+    KLFM_TRACE_SCOPE("TestBuilder::ReadGraphFromFile");
     std::cout << "Reading from '" << fn << "' .. " << std::flush;
     std::ifstream f(fn.c_str());
     current_ln=0;
-    unsigned int cell_idx=0;
+    // Cells are created once all of them are counted, so the storage
+    // is reserved and never reallocated
+    using Line = std::pair<long, std::vector<std::string> >;
+    std::vector<Line> tmpCells, tmpFixed;
     std::vector< std::vector<std::string> > tmpNets;
     while(!f.eof())
     {
@@ -134,39 +138,44 @@ void Novorado::Partition::TestBuilder::ReadGraphFromFile(const std::string &fn)
 #endif
         if(words.size()==2)
         {
-#ifdef CHECK_LOGIC
-            if(
-                    words.front().substr(0,5) == "fixed" &&
-                    m_name2cell.find(words.back()) == m_name2cell.end()
-                    ){
-                throw std::logic_error("Invalid input file");
-            }
-#endif//CHECK_LOGIC
-            if(words.front()=="fixedleft")
-            {
-                Cell* c=(m_name2cell[words.back()]);
-                c->SetFixed();
-                c->SetPartition(&H->p0);
-                continue;
-            } else if(words.front()=="fixedright")
-            {
-                Cell* c=(m_name2cell[words.back()]);
-                c->SetFixed();
-                c->SetPartition(&H->p1);
-                continue;
-            }
-
-            MakeCell(words[0],words[1],cell_idx);
+            if(words.front()=="fixedleft" || words.front()=="fixedright")
+                tmpFixed.emplace_back(current_ln,words);
+            else
+                tmpCells.emplace_back(current_ln,words);
         } else tmpNets.push_back(words);
     }
     f.close();
 
+    H->Reserve(tmpCells.size(),tmpNets.size());
+
+    for(auto& c:tmpCells)
+    {
+        current_ln=c.first;
+        MakeCell(c.second[0],c.second[1]);
+    }
+    H->instances.init(H->m_AllCells->data(),H->m_AllCells->size());
+
+    for(auto& c:tmpFixed)
+    {
+        const std::vector<std::string>& words=c.second;
+#ifdef CHECK_LOGIC
+        if(m_name2cell.find(words.back()) == m_name2cell.end()){
+            std::cout << "Error at " << fn << ":" << c.first << std::endl;
+            throw std::logic_error("Invalid input file");
+        }
+#endif//CHECK_LOGIC
+        Cell* cell=(m_name2cell[words.back()]);
+        cell->SetFixed();
+        cell->SetPartition(words.front()=="fixedleft"?&H->p0:&H->p1);
+    }
+
     unsigned int netIdx=0;
-    H->nets.resize(tmpNets.size());
 
     for(std::vector< std::vector<std::string> >::iterator k=tmpNets.begin();
         k!=tmpNets.end();k++,netIdx++)
-        MakeNet(H->nets[netIdx],*k,netIdx);
+        MakeNet(H->AddNet(k->front()),*k,netIdx);
+
+    H->CheckLimits();
 
     std::cout << " done" << std::endl;
 }
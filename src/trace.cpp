@@ -0,0 +1,155 @@
+#include "trace.h"
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+using namespace Novorado::Partition;
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	// Event fields are atomics, Dump may read a slot being overwritten
+	struct Event
+	{
+		std::atomic<const char*> name{nullptr};
+		std::atomic<uint64_t> stamp{0}; // ns since start shifted left, low bit set for the end
+	};
+
+	struct Buffer
+	{
+		explicit Buffer(uint32_t _tid):tid(_tid),events(Trace::BufferEvents) {}
+
+		void add(const char* name,bool end)
+		{
+			const uint64_t h=head.load(std::memory_order_relaxed);
+			Event& e=events[h&(Trace::BufferEvents-1)];
+			const uint64_t ns=static_cast<uint64_t>(
+				std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now()-start).count());
+			e.name.store(name,std::memory_order_relaxed);
+			e.stamp.store(ns<<1|end,std::memory_order_relaxed);
+			head.store(h+1,std::memory_order_release);
+		}
+
+		static const Clock::time_point start;
+		const uint32_t tid;
+		std::vector<Event> events;
+		std::atomic<uint64_t> head{0};
+		std::atomic<uint64_t> tail{0}; // events before it are cleared
+	};
+
+	const Clock::time_point Buffer::start=Clock::now();
+
+	struct Registry
+	{
+		std::mutex mutex;
+		std::vector<std::shared_ptr<Buffer>> live;
+		std::deque<std::shared_ptr<Buffer>> retired;
+		uint32_t next{1};
+	};
+
+	Registry& registry()
+	{
+		static Registry r;
+		return r;
+	}
+
+	// Registers the buffer of a thread on its first event, retires it on exit
+	struct Local
+	{
+		std::shared_ptr<Buffer> buffer;
+
+		Local()
+		{
+			Registry& r=registry();
+			std::lock_guard<std::mutex> lock(r.mutex);
+			buffer=std::make_shared<Buffer>(r.next++);
+			r.live.push_back(buffer);
+		}
+
+		~Local()
+		{
+			Registry& r=registry();
+			std::lock_guard<std::mutex> lock(r.mutex);
+			for(auto& b:r.live)
+			{
+				if(b!=buffer) continue;
+				b=r.live.back();
+				r.live.pop_back();
+				break;
+			}
+			r.retired.push_back(buffer);
+			if(r.retired.size()>Trace::RetiredBuffers) r.retired.pop_front();
+		}
+	};
+
+	Buffer& local()
+	{
+		thread_local Local l;
+		return *l.buffer;
+	}
+
+	std::vector<std::shared_ptr<Buffer>> buffers()
+	{
+		Registry& r=registry();
+		std::lock_guard<std::mutex> lock(r.mutex);
+		std::vector<std::shared_ptr<Buffer>> rv(r.live.begin(),r.live.end());
+		rv.insert(rv.end(),r.retired.begin(),r.retired.end());
+		return rv;
+	}
+}
+
+void Trace::Begin(const char* name)
+{
+	local().add(name,false);
+}
+
+void Trace::End(const char* name)
+{
+	local().add(name,true);
+}
+
+void Trace::Dump(std::ostream& o)
+{
+	o << "{\"traceEvents\":[";
+	bool first=true;
+	for(auto& b:buffers())
+	{
+		const uint64_t h=b->head.load(std::memory_order_acquire);
+		uint64_t t=b->tail.load(std::memory_order_relaxed);
+		if(h-t>BufferEvents) t=h-BufferEvents;
+		for(;t<h;t++)
+		{
+			const Event& e=b->events[t&(BufferEvents-1)];
+			const char* name=e.name.load(std::memory_order_relaxed);
+			const uint64_t stamp=e.stamp.load(std::memory_order_relaxed);
+			if(!name) continue;
+			// Microseconds, the stream formatting is left alone
+			char ts[32];
+			std::snprintf(ts,sizeof(ts),"%llu.%03u",
+				static_cast<unsigned long long>((stamp>>1)/1000),static_cast<unsigned>((stamp>>1)%1000));
+			o << (first?"":",") << "\n{\"name\":\"" << name << "\",\"ph\":\"" << (stamp&1?'E':'B')
+				<< "\",\"ts\":" << ts << ",\"pid\":1,\"tid\":" << b->tid << "}";
+			first=false;
+		}
+	}
+	o << "\n]}\n";
+}
+
+void Trace::Dump(const std::string& fn)
+{
+	std::ofstream f(fn);
+	if(!f) throw std::runtime_error("Cannot write trace '"+fn+"'");
+	Dump(f);
+}
+
+void Trace::Clear()
+{
+	for(auto& b:buffers()) b->tail.store(b->head.load(std::memory_order_acquire),std::memory_order_relaxed);
+}
@@ -0,0 +1,209 @@
+#include "tuner.h"
+#include "trace.h"
+#include "components.h"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <numeric>
+#include <thread>
+
+using namespace Novorado::Partition;
+
+namespace
+{
+	HypergraphStats::Distribution distribution(std::vector<size_t>& v)
+	{
+		HypergraphStats::Distribution d;
+		if(v.empty()) return d;
+
+		auto at=[&](double q)
+		{
+			auto k=v.begin()+static_cast<std::ptrdiff_t>(q*double(v.size()-1));
+			std::nth_element(v.begin(),k,v.end());
+			return *k;
+		};
+		d.p50=at(0.5);
+		d.p90=at(0.9);
+		d.p99=at(0.99);
+		d.max=*std::max_element(v.begin(),v.end());
+		d.mean=double(std::accumulate(v.begin(),v.end(),size_t(0)))/double(v.size());
+		return d;
+	}
+
+	// Nets over this many times the 99th percentile are left out of gains
+	constexpr size_t LargeNetFactor = 8;
+	// Smaller thresholds would drop ordinary buses
+	constexpr size_t MinLargeNet = 64;
+
+	struct Piece
+	{
+		size_t cells{0};
+		Square square{0};
+	};
+
+	// Connected components, union-find with path halving
+	std::vector<Piece> pieces(const NetlistHypergraph& g,size_t threshold)
+	{
+		const size_t nc=g.m_AllCells->size();
+		std::vector<Index> parent(nc);
+		std::iota(parent.begin(),parent.end(),0);
+		auto root=[&](Index c)
+		{
+			while(parent[c]!=c) c=parent[c]=parent[parent[c]];
+			return c;
+		};
+		for(const Net& n:g.nets)
+		{
+			if(n.m_CellIds.empty() || (threshold && n.Count()>threshold)) continue;
+			const Index a=root(n.m_CellIds.front());
+			for(Index c:n.m_CellIds) parent[root(c)]=root(a);
+		}
+
+		std::vector<Piece> all(nc);
+		for(size_t c=0;c<nc;c++)
+		{
+			Piece& p=all[root(static_cast<Index>(c))];
+			p.cells++;
+			p.square+=(*g.m_AllCells)[c].GetSquare();
+		}
+		all.erase(std::remove_if(all.begin(),all.end(),[](const Piece& p){ return !p.cells; }),all.end());
+		return all;
+	}
+
+	size_t largest(const std::vector<Piece>& v)
+	{
+		size_t rv=0;
+		for(auto& p:v) rv=std::max(rv,p.cells);
+		return rv;
+	}
+
+	// Whole pieces, largest first to the lighter side, keep the tolerance
+	bool packable(std::vector<Piece> v)
+	{
+		std::sort(v.begin(),v.end(),[](const Piece& a,const Piece& b){ return a.square>b.square; });
+		Square side[2]={0,0};
+		for(auto& p:v) side[side[1]<side[0]]+=p.square;
+		return std::max(side[0],side[1])<=(1.0+SQUARE_TOLERANCE)*std::min(side[0],side[1]);
+	}
+}
+
+HypergraphStats HypergraphStats::Compute(const NetlistHypergraph& g)
+{
+	HypergraphStats s;
+	const auto& cells=*g.m_AllCells;
+	s.cells=cells.size();
+	s.nets=g.nets.size();
+
+	std::vector<size_t> v;
+	v.reserve(cells.size());
+	for(const Cell& c:cells)
+	{
+		v.push_back(c.m_Pins.size());
+		if(c.IsFixed()) s.fixed++;
+		s.minSquare=v.size()==1?c.GetSquare():std::min(s.minSquare,c.GetSquare());
+		s.maxSquare=std::max(s.maxSquare,c.GetSquare());
+	}
+	s.degree=distribution(v);
+	s.fixedRatio=s.cells?double(s.fixed)/double(s.cells):0;
+
+	v.clear();
+	for(const Net& n:g.nets)
+	{
+		v.push_back(n.m_CellIds.size());
+		s.pins+=n.m_CellIds.size();
+		if(n.m_CellIds.size()<2) s.singlePinNets++;
+		s.minWeight=v.size()==1?n.GetWeight():std::min(s.minWeight,n.GetWeight());
+		s.maxWeight=std::max(s.maxWeight,n.GetWeight());
+	}
+	s.netSize=distribution(v);
+
+	const auto all=pieces(g,g.m_LargeNetThreshold);
+	s.components=all.size();
+	s.largestComponent=largest(all);
+	return s;
+}
+
+Tuner::Tuner(KLFM& g):m_Graph(g),m_Stats(HypergraphStats::Compute(g))
+{
+}
+
+Tuner::Config Tuner::Choose() const
+{
+	Config c;
+	const HypergraphStats& s=m_Stats;
+
+	const size_t large=std::max(MinLargeNet,LargeNetFactor*s.netSize.p99);
+	if(s.netSize.max>large) c.largeNetThreshold=large;
+
+	// Components as they are once those nets are left out
+	const auto all=pieces(m_Graph,c.largeNetThreshold);
+	if(all.size()>1 && 2*largest(all)<=s.cells)
+	{
+		c.strategy=Strategy::Components;
+		// No piece is cut when packing them whole is balanced already
+		c.minComponent=packable(all)?largest(all)+1:std::max<size_t>(8,s.cells/16);
+	}
+
+	// Many tries are cheap on small designs, one is all large ones afford
+	c.initial.tries=s.pins<100000?8:s.pins<10000000?4:1;
+	const unsigned int hw=std::max(1u,std::thread::hardware_concurrency());
+	c.threads=static_cast<unsigned int>(std::min<size_t>(hw,1+s.pins/50000));
+	c.initial.threads=c.threads;
+	return c;
+}
+
+Tuner::Config Tuner::Trial(Config c)
+{
+	if(c.strategy!=Strategy::Portfolio) return c;
+
+	m_Graph.m_LargeNetThreshold=c.largeNetThreshold;
+	InitialPartitioner init(m_Graph);
+
+	std::vector<InitialPartitioner::Result> r;
+	for(auto m:c.initial.methods) r.push_back(init.Run(m,c.initial.seed));
+
+	// Balanced methods within 10% of the best balanced cut stay
+	Weight best=std::numeric_limits<Weight>::max();
+	for(auto& x:r) if(x.balanced) best=std::min(best,x.cut);
+	if(best==std::numeric_limits<Weight>::max()) return c;
+
+	std::vector<InitialPartitioner::Method> kept;
+	for(size_t i=0;i<r.size();i++)
+	{
+		if(r[i].balanced && r[i].cut<=best+best/10) kept.push_back(c.initial.methods[i]);
+	}
+	c.initial.methods=kept;
+	return c;
+}
+
+void Tuner::Apply(const Config& c)
+{
+	KLFM_TRACE_SCOPE("Tuner::Apply");
+	m_Graph.m_LargeNetThreshold=c.largeNetThreshold;
+
+	// The budget covers the initial partition and Refine
+	const auto started=KLFM::Clock::now();
+	if(c.strategy==Strategy::Components)
+	{
+		ComponentPartitioner::Params p;
+		p.threads=c.threads;
+		p.minSize=c.minComponent;
+		p.deadline=m_Graph.GetDeadline();
+		if(c.budget>=0)
+		{
+			p.deadline=std::min(p.deadline,started+
+				std::chrono::duration_cast<KLFM::Clock::duration>(std::chrono::duration<double>(c.budget)));
+		}
+		p.progress=m_Graph.GetProgress();
+		ComponentPartitioner(m_Graph,p).Partition();
+	}
+	else InitialPartitioner(m_Graph).Apply(c.initial);
+
+	double budget=c.budget;
+	if(budget>=0)
+	{
+		budget=std::max(0.0,budget-std::chrono::duration<double>(KLFM::Clock::now()-started).count());
+	}
+	m_Graph.SetTimeBudget(budget);
+	m_Graph.Refine();
+}
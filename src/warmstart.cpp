@@ -0,0 +1,93 @@
+#include "warmstart.h"
+#include <fstream>
+#include <sstream>
+
+using namespace Novorado::Partition;
+
+WarmStart::WarmStart(NetlistHypergraph& g):
+	m_Graph(g),m_Sides(g.m_AllCells->size(),CellState::NoSide)
+{
+	m_Names.reserve(g.m_AllCells->size());
+	for(const Cell& c:*g.m_AllCells) m_Names.emplace(c.GetName(),c.GetUnsignedId());
+}
+
+void WarmStart::set(const string& name,uint8_t side)
+{
+	auto i=m_Names.find(name);
+	if(i==m_Names.end())
+	{
+		m_Unknown++;
+		return;
+	}
+	if(m_Sides[i->second]==CellState::NoSide) m_Matched++;
+	m_Sides[i->second]=side;
+}
+
+void WarmStart::ReadLockers(const string& left,const string& right)
+{
+	const string files[2]={left,right};
+	for(uint8_t side=0;side<2;side++)
+	{
+		std::ifstream f(files[side]);
+		if(!f) throw std::runtime_error("Cannot open solution file '"+files[side]+"'");
+		for(string name;f >> name;) set(name,side);
+	}
+}
+
+void WarmStart::ReadPart(const string& fn)
+{
+	std::ifstream f(fn);
+	if(!f) throw std::runtime_error("Cannot open solution file '"+fn+"'");
+
+	long ln=0;
+	for(string l;std::getline(f,l);)
+	{
+		ln++;
+		std::stringstream s(l);
+		string name;
+		int side=-1;
+		if(!(s >> name)) continue;
+		if(!(s >> side) || (side!=0 && side!=1))
+		{
+			std::stringstream msg;
+			msg << "Wrong side for cell '" << name << "' at " << fn << ":" << ln;
+			throw std::runtime_error(msg.str());
+		}
+		set(name,static_cast<uint8_t>(side));
+	}
+}
+
+void WarmStart::WritePart(const string& fn) const
+{
+	std::ofstream f(fn);
+	if(!f) throw std::runtime_error("Cannot write solution file '"+fn+"'");
+	for(const Cell& c:*m_Graph.m_AllCells)
+	{
+		f << c.GetName() << " " << (c.GetPartition()==&m_Graph.p1?1:0) << "\n";
+	}
+}
+
+void WarmStart::Apply()
+{
+	auto& cells=*m_Graph.m_AllCells;
+
+	Square area[2]={0,0};
+	for(size_t c=0;c<cells.size();c++)
+	{
+		if(cells[c].IsFixed()) m_Sides[c]=cells[c].GetPartition()==&m_Graph.p1;
+		if(m_Sides[c]!=CellState::NoSide) area[m_Sides[c]]+=cells[c].GetSquare();
+	}
+
+	for(size_t c=0;c<cells.size();c++)
+	{
+		uint8_t s=m_Sides[c];
+		if(s==CellState::NoSide)
+		{
+			s=area[0]<=area[1]?0:1;
+			area[s]+=cells[c].GetSquare();
+		}
+		cells[c].SetPartition(s?&m_Graph.p1:&m_Graph.p0);
+	}
+
+	m_Graph.SyncLockers();
+}